@@ -0,0 +1,90 @@
+//
+//  AhoCorasick_bench.cpp
+//
+//  Construction and matching time of AhoCorasick over keys sampled from text, compared with SetBom.
+//  The text is read from a file, or generated over 26 letters.
+//  usage: AhoCorasick_bench [text_file | text_size [num_keys]]
+//
+
+#include "sim_ds/string_util/AhoCorasick.hpp"
+#include "sim_ds/string_util/PatternMatching.hpp"
+
+#include <fstream>
+#include <iostream>
+#include <random>
+
+namespace {
+
+volatile uint64_t sink;
+
+std::string load_text(const std::string& arg) {
+    std::ifstream ifs(arg, std::ios::binary);
+    std::string text;
+    if (ifs) {
+        text.assign(std::istreambuf_iterator<char>(ifs), std::istreambuf_iterator<char>());
+    } else {
+        std::mt19937_64 rnd(0);
+        std::geometric_distribution<int> dist(4.0 / 26);
+        text.resize(std::stoull(arg));
+        for (auto& c : text)
+            c = 'a' + dist(rnd) % 26;
+    }
+    // '\0' is reserved as the leaf label of trie.
+    std::replace(text.begin(), text.end(), '\0', ' ');
+    return text;
+}
+
+template <class Process>
+void bench(const char* name, size_t text_size, Process process) {
+    sim_ds::Stopwatch sw;
+    auto cnt = process();
+    auto ms = sw.get_milli_sec();
+    std::cout << name << "\t" << ms << " ms\t" << text_size / ms / 1000 << " MB/s\t" << cnt << std::endl;
+    sink = cnt;
+}
+
+void bench_keys(const char* title, const std::string& text, const std::vector<std::string>& keys) {
+    std::cout << title << ": " << keys.size() << " keys" << std::endl;
+    sim_ds::Stopwatch sw;
+    sim_ds::AhoCorasick ac(keys);
+    auto ms = sw.get_milli_sec();
+    std::cout << "build\t" << ms << " ms\t" << ac.size_in_bytes() << " bytes" << std::endl;
+    bench("find_all", text.size(), [&] {return ac.find_all(text).size();});
+    bench("prefiltered", text.size(), [&] {return ac.find_all_prefiltered(text).size();});
+    sim_ds::pattern_matching::SetBom set_bom(keys);
+    bench("SetBom", text.size(), [&] {return set_bom.find_all(text).size();});
+}
+
+}
+
+int main(int argc, char* argv[]) {
+    auto text = load_text(argc > 1 ? argv[1] : std::to_string(64u<<20));
+    size_t num_keys = argc > 2 ? std::stoull(argv[2]) : 5000;
+    std::cout << "text size: " << text.size() << std::endl;
+
+    std::mt19937_64 rnd(1);
+    std::vector<std::string> keys;
+    for (size_t i = 0; i < num_keys; i++) {
+        size_t size = 4 + rnd() % 9;
+        keys.push_back(text.substr(rnd() % (text.size() - size), size));
+    }
+    // Duplicates are reported once by AhoCorasick, while once for each by SetBom.
+    std::sort(keys.begin(), keys.end());
+    keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+    bench_keys("sampled", text, keys);
+
+    // Keys beginning with the rarest byte in text, where the prefilter skips most of text.
+    std::array<size_t, 0x100> freq = {};
+    for (uint8_t c : text)
+        freq[c]++;
+    uint8_t rare = 1;
+    for (size_t c = 1; c < 0x100; c++) {
+        if (freq[c] > 0 and (freq[rare] == 0 or freq[c] < freq[rare]))
+            rare = c;
+    }
+    for (auto& key : keys)
+        key[0] = rare;
+    std::sort(keys.begin(), keys.end());
+    keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+    bench_keys("rare heads", text, keys);
+}
@@ -0,0 +1,78 @@
+//
+//  CDRWArray_bench.cpp
+//
+//  Space and throughput of CDRWArray (tables per width) versus BlockedCDRWArray (blocks with own widths).
+//  usage: CDRWArray_bench [size]
+//
+
+#include "sim_ds/CDRWArray.hpp"
+
+#include <iostream>
+#include <random>
+
+namespace {
+
+volatile uint64_t sink;
+
+// Values of which widths follow geometric distribution, as counters and lengths usually do.
+std::vector<uint64_t> skewed_values(size_t size, std::mt19937_64& rnd) {
+    std::geometric_distribution<unsigned> width_dist(0.25);
+    std::vector<uint64_t> values(size);
+    for (auto& v : values) {
+        auto w = std::min(64u, width_dist(rnd));
+        v = w == 0 ? 0 : (rnd() & sim_ds::bit_util::WidthMask(w)) | (1ull << (w-1));
+    }
+    return values;
+}
+
+}
+
+template <class Array>
+void bench(const char* name, const std::vector<uint64_t>& values, const std::vector<size_t>& queries) {
+    sim_ds::Stopwatch sw;
+    Array arr(values.size());
+    for (size_t i = 0; i < values.size(); i++)
+        arr.set(i, values[i]);
+    auto set_ms = sw.get_milli_sec();
+
+    sw = sim_ds::Stopwatch();
+    uint64_t sum = 0;
+    for (auto q : queries)
+        sum += arr.get(q);
+    auto get_ms = sw.get_milli_sec();
+    sink = sum;
+
+    // Rewrite with values of another distribution, which changes widths of elements.
+    sw = sim_ds::Stopwatch();
+    for (size_t k = 0; k < queries.size(); k++)
+        arr.set(queries[k], values[queries.size() - 1 - k]);
+    auto update_ms = sw.get_milli_sec();
+
+    sw = sim_ds::Stopwatch();
+    Array built(values.begin(), values.end());
+    auto build_ms = sw.get_milli_sec();
+    sink = built.get(0);
+
+    auto n = values.size();
+    std::cout << name << "\t"
+              << arr.size_in_bytes() * 8. / n << " bits/elem\t"
+              << set_ms * 1e6 / n << " ns/set\t"
+              << build_ms * 1e6 / n << " ns/build\t"
+              << get_ms * 1e6 / queries.size() << " ns/get\t"
+              << update_ms * 1e6 / queries.size() << " ns/update" << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+    size_t size = argc > 1 ? std::stoull(argv[1]) : 1u<<22;
+
+    std::mt19937_64 rnd(0);
+    auto values = skewed_values(size, rnd);
+    std::vector<size_t> queries(size);
+    for (auto& q : queries)
+        q = rnd() % size;
+
+    std::cout << "size: " << size << std::endl;
+    bench<sim_ds::CDRWArray>("CHT-based", values, queries);
+    bench<sim_ds::BlockedCDRWArray>("Blocked", values, queries);
+    return 0;
+}
@@ -0,0 +1,79 @@
+//
+//  CHT_bench.cpp
+//
+//  Throughput of CHT for one-by-one, batch operations and bulk build.
+//  usage: CHT_bench [num_keys]
+//
+
+#include "sim_ds/CHT.hpp"
+
+#include <iostream>
+#include <random>
+
+namespace {
+
+constexpr unsigned kKeyBits = 40;
+constexpr unsigned kValueBits = 32;
+
+volatile uint64_t sink;
+
+void report(const char* name, size_t n, double ms) {
+    std::cout << name << "\t" << ms << " ms\t" << n / ms / 1000 << " Mops/s" << std::endl;
+}
+
+}
+
+int main(int argc, char* argv[]) {
+    size_t num_keys = argc > 1 ? std::stoull(argv[1]) : 1u<<22;
+
+    std::mt19937_64 rnd(0);
+    std::vector<uint64_t> keys(num_keys), values(num_keys);
+    for (size_t i = 0; i < num_keys; i++) {
+        keys[i] = rnd() % (1ull<<kKeyBits);
+        values[i] = rnd() % (1ull<<kValueBits);
+    }
+    std::vector<uint64_t> queries(num_keys);
+    for (auto& q : queries)
+        q = keys[rnd() % num_keys];
+
+    std::cout << "keys: " << num_keys << std::endl;
+    {
+        sim_ds::CHT<kValueBits> cht(kKeyBits);
+        sim_ds::Stopwatch sw;
+        for (size_t i = 0; i < num_keys; i++)
+            cht.set(keys[i], values[i]);
+        report("set", num_keys, sw.get_milli_sec());
+
+        sw = sim_ds::Stopwatch();
+        uint64_t sum = 0;
+        for (auto q : queries)
+            sum += cht.get(q).second;
+        report("get", num_keys, sw.get_milli_sec());
+        sink = sum;
+    }
+    {
+        sim_ds::CHT<kValueBits> cht(kKeyBits);
+        sim_ds::Stopwatch sw;
+        cht.set_batch(keys.begin(), keys.end(), values.begin());
+        report("set_batch", num_keys, sw.get_milli_sec());
+
+        std::vector<std::pair<bool, uint64_t>> res(num_keys);
+        sw = sim_ds::Stopwatch();
+        cht.get_batch(queries.begin(), queries.end(), res.begin());
+        report("get_batch", num_keys, sw.get_milli_sec());
+        uint64_t sum = 0;
+        for (auto& r : res)
+            sum += r.second;
+        sink = sum;
+    }
+    {
+        std::vector<std::pair<uint64_t, uint64_t>> kvs(num_keys);
+        for (size_t i = 0; i < num_keys; i++)
+            kvs[i] = {keys[i], values[i]};
+        sim_ds::Stopwatch sw;
+        sim_ds::CHT<kValueBits> cht(kKeyBits, kvs.begin(), kvs.end());
+        report("build", num_keys, sw.get_milli_sec());
+        sink = cht.size();
+    }
+    return 0;
+}
@@ -0,0 +1,84 @@
+//
+//  ConcurrentCHT_bench.cpp
+//
+//  Throughput of ConcurrentCHT versus CHT wrapped by a mutex, on read-mostly workloads.
+//  usage: ConcurrentCHT_bench [num_keys] [max_threads]
+//
+
+#include "sim_ds/ConcurrentCHT.hpp"
+
+#include <iostream>
+#include <random>
+#include <thread>
+
+namespace {
+
+constexpr unsigned kKeyBits = 32;
+constexpr unsigned kValueBits = 32;
+constexpr size_t kOpsPerThread = 1u<<20;
+constexpr unsigned kWritePermille = 10;
+
+volatile uint64_t sink;
+
+class LockedCHT {
+    sim_ds::CHT<kValueBits> cht_;
+    mutable std::mutex mutex_;
+public:
+    explicit LockedCHT(unsigned key_bits) : cht_(key_bits) {}
+    std::pair<bool, uint64_t> get(uint64_t key) const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return cht_.get(key);
+    }
+    void set(uint64_t key, uint64_t value) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        cht_.set(key, value);
+    }
+};
+
+template <class Table>
+double throughput(Table& table, size_t num_keys, unsigned num_threads) {
+    std::vector<std::thread> threads;
+    std::atomic<uint64_t> checksum = 0;
+    sim_ds::Stopwatch sw;
+    for (unsigned t = 0; t < num_threads; t++) {
+        threads.emplace_back([&, t] {
+            std::mt19937_64 rnd(t);
+            uint64_t sum = 0;
+            for (size_t i = 0; i < kOpsPerThread; i++) {
+                auto key = rnd() % num_keys;
+                if (rnd() % 1000 < kWritePermille)
+                    table.set(key, i);
+                else
+                    sum += table.get(key).second;
+            }
+            checksum += sum;
+        });
+    }
+    for (auto& t : threads)
+        t.join();
+    auto ms = sw.get_milli_sec();
+    sink = checksum;
+    return num_threads * kOpsPerThread / ms / 1000;
+}
+
+}
+
+int main(int argc, char* argv[]) {
+    size_t num_keys = argc > 1 ? std::stoull(argv[1]) : 1u<<20;
+    unsigned max_threads = argc > 2 ? std::stoul(argv[2]) : std::max(1u, std::thread::hardware_concurrency());
+
+    std::cout << "keys: " << num_keys << ", writes: " << kWritePermille/10. << "%" << std::endl;
+    std::cout << "threads\tConcurrentCHT[Mops/s]\tmutex+CHT[Mops/s]" << std::endl;
+    for (unsigned th = 1; th <= max_threads; th *= 2) {
+        sim_ds::ConcurrentCHT<kValueBits> concurrent(kKeyBits);
+        LockedCHT locked(kKeyBits);
+        for (size_t i = 0; i < num_keys; i++) {
+            concurrent.set(i, i);
+            locked.set(i, i);
+        }
+        auto c = throughput(concurrent, num_keys, th);
+        auto l = throughput(locked, num_keys, th);
+        std::cout << th << "\t" << c << "\t" << l << std::endl;
+    }
+    return 0;
+}
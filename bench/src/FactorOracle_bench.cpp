@@ -0,0 +1,72 @@
+//
+//  FactorOracle_bench.cpp
+//
+//  Construction time and size of FactorOracle, and time of factor queries, by width of ids.
+//  The text is read from a file, or generated over an alphabet of given size.
+//  usage: FactorOracle_bench [text_file | text_size [alphabet_size]]
+//
+
+#include "sim_ds/string_util/FactorOracle.hpp"
+
+#include <fstream>
+#include <iostream>
+#include <random>
+
+namespace {
+
+volatile uint64_t sink;
+
+std::string load_text(int argc, char* argv[]) {
+    std::string arg = argc > 1 ? argv[1] : std::to_string(100u<<20);
+    std::ifstream ifs(arg, std::ios::binary);
+    if (ifs) {
+        std::string text((std::istreambuf_iterator<char>(ifs)), std::istreambuf_iterator<char>());
+        // '\0' is reserved as the label of initial state.
+        std::replace(text.begin(), text.end(), '\0', ' ');
+        return text;
+    }
+    size_t size = std::stoull(arg);
+    size_t alphabet_size = argc > 2 ? std::stoull(argv[2]) : 26;
+    // Skewed distribution, like natural language texts.
+    std::mt19937_64 rnd(0);
+    std::geometric_distribution<int> dist(4.0 / alphabet_size);
+    std::string text(size, 0);
+    for (auto& c : text)
+        c = 'a' + dist(rnd) % alphabet_size;
+    return text;
+}
+
+template <class Oracle>
+void bench(const char* name, const std::string& text) {
+    sim_ds::Stopwatch sw;
+    Oracle fo(text);
+    auto ms = sw.get_milli_sec();
+    std::cout << name << std::endl;
+    std::cout << "build\t" << ms << " ms\t" << text.size() / ms / 1000 << " MB/s" << std::endl;
+    std::cout << "size\t" << fo.size_in_bytes() << " bytes\t" << double(fo.size_in_bytes()) / text.size() << " bytes/char" << std::endl;
+
+    std::mt19937_64 rnd(1);
+    constexpr size_t kNumQueries = 1u<<20;
+    constexpr size_t kQueryLength = 32;
+    std::vector<std::string_view> queries;
+    std::string_view text_view(text);
+    for (size_t i = 0; i < kNumQueries; i++)
+        queries.push_back(text_view.substr(rnd() % (text.size() - kQueryLength), kQueryLength));
+    sw = sim_ds::Stopwatch();
+    size_t cnt = 0;
+    for (auto q : queries)
+        cnt += fo.accept(q);
+    ms = sw.get_milli_sec();
+    std::cout << "accept\t" << ms << " ms\t" << kNumQueries / ms / 1000 << " Mq/s" << std::endl;
+    sink = cnt;
+}
+
+}
+
+int main(int argc, char* argv[]) {
+    auto text = load_text(argc, argv);
+    std::cout << "text size: " << text.size() << std::endl;
+
+    bench<sim_ds::FactorOracle>("32-bit ids", text);
+    bench<sim_ds::FactorOracle64>("64-bit ids", text);
+}
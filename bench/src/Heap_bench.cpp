@@ -0,0 +1,98 @@
+//
+//  Heap_bench.cpp
+//
+//  Throughput of d-ary heaps against std::priority_queue,
+//  and of monotone queues on a Dijkstra-like workload.
+//  usage: Heap_bench [num_values]
+//
+
+#include "sim_ds/Heap.hpp"
+#include "sim_ds/RadixHeap.hpp"
+
+#include <iostream>
+#include <random>
+
+namespace {
+
+volatile uint64_t sink;
+
+void report(const char* name, size_t n, double ms) {
+    std::cout << name << "\t" << ms << " ms\t" << n / ms / 1000 << " Mops/s" << std::endl;
+}
+
+template <class Queue>
+void bench(const char* name, const std::vector<uint64_t>& values) {
+    Queue queue;
+    sim_ds::Stopwatch sw;
+    for (auto v : values)
+        queue.push(v);
+    uint64_t sum = 0;
+    while (!queue.empty()) {
+        sum += queue.top();
+        queue.pop();
+    }
+    report(name, values.size() * 2, sw.get_milli_sec());
+    sink = sum;
+}
+
+// Each pop pushes up to two keys of the popped one plus small steps.
+template <class Queue>
+void bench_monotone(const char* name, size_t n, uint64_t max_step) {
+    std::mt19937_64 rnd(0);
+    Queue queue;
+    for (size_t i = 0; i < 1024; i++)
+        queue.push(rnd() % max_step);
+    sim_ds::Stopwatch sw;
+    uint64_t sum = 0;
+    size_t ops = 0;
+    for (size_t i = 0; i < n and !queue.empty(); i++) {
+        auto key = queue.top();
+        queue.pop();
+        sum += key;
+        for (auto k = i % 3; k > 0; k--)
+            queue.push(key + rnd() % max_step);
+        ops += 1 + i % 3;
+    }
+    report(name, ops, sw.get_milli_sec());
+    sink = sum;
+}
+
+}
+
+int main(int argc, char* argv[]) {
+    size_t num_values = argc > 1 ? std::stoull(argv[1]) : 1u<<22;
+
+    std::mt19937_64 rnd(0);
+    std::vector<uint64_t> values(num_values);
+    for (auto& v : values)
+        v = rnd();
+
+    std::cout << "push + pop of " << num_values << " values" << std::endl;
+    bench<std::priority_queue<uint64_t, std::vector<uint64_t>, std::greater<uint64_t>>>("std::priority_queue", values);
+    bench<sim_ds::DaryHeap<uint64_t, std::less<uint64_t>, 2>>("DaryHeap<2>", values);
+    bench<sim_ds::DaryHeap<uint64_t, std::less<uint64_t>, 4>>("DaryHeap<4>", values);
+    bench<sim_ds::DaryHeap<uint64_t, std::less<uint64_t>, 8>>("DaryHeap<8>", values);
+
+    sim_ds::IndexedHeap<uint64_t> indexed(num_values);
+    sim_ds::Stopwatch sw;
+    for (size_t i = 0; i < num_values; i++)
+        indexed.push(i, values[i]);
+    for (size_t i = 0; i < num_values; i++)
+        indexed.decrease_key(i, values[i] / 2);
+    uint64_t sum = 0;
+    while (!indexed.empty()) {
+        sum += indexed.top_key();
+        indexed.pop();
+    }
+    report("IndexedHeap<4>", num_values * 3, sw.get_milli_sec());
+    sink = sum;
+
+    for (uint64_t max_step : {16ull, 1ull<<20}) {
+        std::cout << "monotone with step < " << max_step << std::endl;
+        bench_monotone<std::priority_queue<uint64_t, std::vector<uint64_t>, std::greater<uint64_t>>>("std::priority_queue", num_values, max_step);
+        bench_monotone<sim_ds::DaryHeap<uint64_t, std::less<uint64_t>, 4>>("DaryHeap<4>", num_values, max_step);
+        bench_monotone<sim_ds::RadixHeap<uint64_t>>("RadixHeap", num_values, max_step);
+        if (max_step <= 1024)
+            bench_monotone<sim_ds::BucketQueue<uint64_t>>("BucketQueue", num_values, max_step);
+    }
+}
@@ -0,0 +1,104 @@
+//
+//  MultipleVector_bench.cpp
+//
+//  Row and column access patterns of MultipleVector, StaticMultipleVector and ColumnarMultipleVector,
+//  with blocks of {4, 1} bytes like base and check of double arrays.
+//  usage: MultipleVector_bench [num_blocks]
+//
+
+#include "sim_ds/MultipleVector.hpp"
+
+#include <iostream>
+#include <random>
+
+namespace {
+
+volatile uint64_t sink;
+
+void report(const char* name, size_t n, double ms) {
+    std::cout << name << "\t" << ms << " ms\t" << n / ms / 1000 << " Mops/s" << std::endl;
+}
+
+// Field access assembled byte by byte, as a baseline.
+uint64_t bytewise_get(const uint8_t* pointer, size_t width) {
+    uint64_t value = 0;
+    for (size_t i = 0; i < width; i++)
+        value |= uint64_t(pointer[i]) << (i * 8);
+    return value;
+}
+
+template <class Vector>
+void fill(Vector& vec, size_t n) {
+    std::mt19937_64 rnd(0);
+    vec.resize(n);
+    for (size_t i = 0; i < n; i++) {
+        vec.template set_nested_element<0>(i, rnd() & 0xFFFFFFFF);
+        vec.template set_nested_element<1>(i, rnd() & 0xFF);
+    }
+}
+
+template <class Vector>
+void bench(const char* name, const Vector& vec, const std::vector<size_t>& indices) {
+    std::cout << name << std::endl;
+    sim_ds::Stopwatch sw;
+    uint64_t sum = 0;
+    for (auto i : indices)
+        sum += vec.template nested_element<0>(i) ^ vec.template nested_element<1>(i);
+    report("  row random", indices.size(), sw.get_milli_sec());
+    sink = sum;
+
+    sw = sim_ds::Stopwatch();
+    sum = 0;
+    for (size_t i = 0; i < vec.size(); i++)
+        sum += vec.template nested_element<0>(i);
+    report("  column scan", vec.size(), sw.get_milli_sec());
+    sink = sum;
+
+    std::vector<uint64_t> column(vec.size());
+    sw = sim_ds::Stopwatch();
+    vec.template copy_elements<0>(0, vec.size(), column.begin());
+    report("  column copy", vec.size(), sw.get_milli_sec());
+    sink = column.back();
+}
+
+}
+
+int main(int argc, char* argv[]) {
+    size_t num_blocks = argc > 1 ? std::stoull(argv[1]) : 1u<<24;
+
+    std::mt19937_64 rnd(1);
+    std::vector<size_t> indices(num_blocks);
+    for (auto& i : indices)
+        i = rnd() % num_blocks;
+
+    sim_ds::MultipleVector row{4, 1};
+    fill(row, num_blocks);
+    sim_ds::StaticMultipleVector<4, 1> static_row;
+    fill(static_row, num_blocks);
+    sim_ds::ColumnarMultipleVector column{4, 1};
+    fill(column, num_blocks);
+
+    // Baseline of byte loops on the same row layout.
+    std::vector<uint8_t> bytes(num_blocks * 5);
+    for (size_t i = 0; i < num_blocks; i++) {
+        auto b = row.block(i);
+        for (size_t k = 0; k < 4; k++)
+            bytes[i*5 + k] = b.get<0>() >> (k*8);
+        bytes[i*5 + 4] = b.get<1>();
+    }
+    std::cout << "bytewise" << std::endl;
+    sim_ds::Stopwatch sw;
+    uint64_t sum = 0;
+    for (auto i : indices)
+        sum += bytewise_get(&bytes[i*5], 4) ^ bytewise_get(&bytes[i*5 + 4], 1);
+    report("  row random", num_blocks, sw.get_milli_sec());
+    sw = sim_ds::Stopwatch();
+    for (size_t i = 0; i < num_blocks; i++)
+        sum += bytewise_get(&bytes[i*5], 4);
+    report("  column scan", num_blocks, sw.get_milli_sec());
+    sink = sum;
+
+    bench("MultipleVector", row, indices);
+    bench("StaticMultipleVector", static_row, indices);
+    bench("ColumnarMultipleVector", column, indices);
+}
@@ -0,0 +1,88 @@
+//
+//  PatternMatching_bench.cpp
+//
+//  Time of finding all occurrences by each algorithm, over keys of several lengths sampled from text.
+//  The text is read from a file, or generated over an alphabet of given size.
+//  usage: PatternMatching_bench [text_file | text_size [alphabet_size]]
+//
+
+#include "sim_ds/string_util/PatternMatching.hpp"
+
+#include <fstream>
+#include <iostream>
+#include <random>
+
+namespace {
+
+volatile uint64_t sink;
+
+std::string load_text(int argc, char* argv[]) {
+    std::string arg = argc > 1 ? argv[1] : std::to_string(64u<<20);
+    std::ifstream ifs(arg, std::ios::binary);
+    if (ifs) {
+        return std::string((std::istreambuf_iterator<char>(ifs)), std::istreambuf_iterator<char>());
+    }
+    size_t size = std::stoull(arg);
+    size_t alphabet_size = argc > 2 ? std::stoull(argv[2]) : 26;
+    // Skewed distribution, like natural language texts.
+    std::mt19937_64 rnd(0);
+    std::geometric_distribution<int> dist(std::min(0.5, 4.0 / alphabet_size));
+    std::string text(size, 0);
+    for (auto& c : text)
+        c = 'a' + dist(rnd) % alphabet_size;
+    return text;
+}
+
+constexpr size_t kNumKeys = 4;
+
+template <class Matcher>
+void bench(const char* name, std::string_view text, const std::vector<std::string_view>& keys) {
+    sim_ds::Stopwatch sw;
+    size_t cnt = 0;
+    for (auto key : keys)
+        cnt += Matcher(key).find_all(text).size();
+    auto ms = sw.get_milli_sec();
+    std::cout << name << "\t" << ms / keys.size() << " ms\t" << text.size() * keys.size() / ms / 1000 << " MB/s\t" << cnt << std::endl;
+    sink = cnt;
+}
+
+// Counting by callbacks, without vectors of matches.
+template <class Matcher>
+void bench_count(const char* name, std::string_view text, const std::vector<std::string_view>& keys) {
+    sim_ds::Stopwatch sw;
+    size_t cnt = 0;
+    for (auto key : keys)
+        cnt += Matcher(key).count(text);
+    auto ms = sw.get_milli_sec();
+    std::cout << name << "\t" << ms / keys.size() << " ms\t" << text.size() * keys.size() / ms / 1000 << " MB/s\t" << cnt << std::endl;
+    sink = cnt;
+}
+
+}
+
+int main(int argc, char* argv[]) {
+    using namespace sim_ds::pattern_matching;
+    auto text = load_text(argc, argv);
+    std::string_view text_view(text);
+    std::cout << "text size: " << text.size() << std::endl;
+
+    std::mt19937_64 rnd(1);
+    for (size_t key_size : {2, 4, 8, 16, 32, 64, 256}) {
+        std::vector<std::string_view> keys;
+        for (size_t i = 0; i < kNumKeys; i++)
+            keys.push_back(text_view.substr(rnd() % (text.size() - key_size), key_size));
+        std::cout << "key size: " << key_size << "\t(auto: " << Auto(keys.front()).algorithm() << ")" << std::endl;
+        if (key_size <= 16)
+            bench<Simple>("Simple", text, keys);
+        bench<Kmp>("Kmp", text, keys);
+        bench<Bm>("Bm", text, keys);
+        bench<Bom>("Bom", text, keys);
+        bench<TurboBom>("TurboBom", text, keys);
+        bench<SundayQS>("SundayQS", text, keys);
+        bench<SundayMS>("SundayMS", text, keys);
+        bench<Simd>("Simd", text, keys);
+        bench<Auto>("Auto", text, keys);
+        bench_count<Auto>("Auto count", text, keys);
+        bench<ParallelMatcher<Auto>>("Auto parallel", text, keys);
+    }
+}
@@ -0,0 +1,44 @@
+//
+//  sort_bench.cpp
+//
+//  Time of sorting random integers by std::sort, HeapSort, radix sorts and SampleSort.
+//  usage: sort_bench [num_values]
+//
+
+#include "sim_ds/sort.hpp"
+
+#include <iostream>
+#include <random>
+
+namespace {
+
+volatile uint64_t sink;
+
+template <class Sort>
+void bench(const char* name, const std::vector<uint64_t>& src, Sort sort) {
+    auto vec = src;
+    sim_ds::Stopwatch sw;
+    sort(vec.begin(), vec.end());
+    auto ms = sw.get_milli_sec();
+    std::cout << name << "\t" << ms << " ms\t" << vec.size() / ms / 1000 << " M/s" << std::endl;
+    sink = vec[vec.size() / 2];
+}
+
+}
+
+int main(int argc, char* argv[]) {
+    size_t num_values = argc > 1 ? std::stoull(argv[1]) : 1u<<24;
+
+    std::mt19937_64 rnd(0);
+    std::vector<uint64_t> values(num_values);
+    for (auto& v : values)
+        v = rnd();
+
+    using It = std::vector<uint64_t>::iterator;
+    bench("std::sort", values, [](It b, It e) {std::sort(b, e);});
+    if (num_values <= 1u<<22)
+        bench("HeapSort", values, [](It b, It e) {sim_ds::HeapSort(b, e);});
+    bench("RadixSort", values, [](It b, It e) {sim_ds::RadixSort(b, e);});
+    bench("MsdRadixSort", values, [](It b, It e) {sim_ds::MsdRadixSort(b, e);});
+    bench("SampleSort", values, [](It b, It e) {sim_ds::SampleSort(b, e);});
+}
@@ -13,11 +13,14 @@
 #include "sim_ds/MultiBitVector.hpp"
 #include "sim_ds/WaveletTree.hpp"
 #include "sim_ds/DacVector.hpp"
+#include "sim_ds/MappedFile.hpp"
 #include "sim_ds/Heap.hpp"
+#include "sim_ds/RadixHeap.hpp"
 #include "sim_ds/sort.hpp"
 #include "sim_ds/string_util/SuffixArray.hpp"
 #include "sim_ds/string_util/FactorOracle.hpp"
 #include "sim_ds/string_util/PatternMatching.hpp"
+#include "sim_ds/string_util/AhoCorasick.hpp"
 #include "sim_ds/string_util/graph_util.hpp"
 #include "sim_ds/string_util/Samc.hpp"
 #include "sim_ds/EmptyLinkedVector.hpp"
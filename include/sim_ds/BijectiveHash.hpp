@@ -2,6 +2,11 @@
 #define _SIM_DS_BIJECTIVE_HASH_
 
 #include <cstdint>
+#include <cstddef>
+#include <cassert>
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
 
 namespace sim_ds {
 
@@ -14,7 +19,7 @@ public:
 
     template<unsigned K>
     uint64_t hash(uint64_t x) const {
-        x = (x ^ (x >> (shifts_+K)));
+        x = (x ^ (x >> shift<K>()));
         return x;
     }
     template<unsigned K>
@@ -22,6 +27,33 @@ public:
         return hash<K>(x);
     }
 
+    template<unsigned K>
+    unsigned shift() const {return shifts_+K;}
+
+};
+
+// Xorshift of which width is fixed at compile time.
+template <unsigned Width>
+class StaticXorshift {
+    static_assert(0 < Width and Width <= 64);
+public:
+    explicit StaticXorshift(unsigned width=Width) {
+        assert(width == Width);
+    }
+
+    template<unsigned K>
+    uint64_t hash(uint64_t x) const {
+        x = (x ^ (x >> shift<K>()));
+        return x;
+    }
+    template<unsigned K>
+    uint64_t ihash(uint64_t x) const {
+        return hash<K>(x);
+    }
+
+    template<unsigned K>
+    static constexpr unsigned shift() {return (Width+1)/2+K;}
+
 };
 
 constexpr uint64_t PRIME_TABLE[][2][3] = {
@@ -102,24 +134,63 @@ public:
 
     template<unsigned K>
     uint64_t hash(uint64_t x) const {
-        x = (x * PRIME_TABLE[width_][0][K]) & mask_;
+        x = (x * prime<K>()) & mask_;
         return x;
     }
 
     template<unsigned K>
     uint64_t ihash(uint64_t x) const {
-        x = (x * PRIME_TABLE[width_][1][K]) & mask_;
+        x = (x * inverse_prime<K>()) & mask_;
         return x;
     }
+
+    template<unsigned K>
+    uint64_t prime() const {return PRIME_TABLE[width_][0][K];}
+    template<unsigned K>
+    uint64_t inverse_prime() const {return PRIME_TABLE[width_][1][K];}
+    uint64_t mask() const {return mask_;}
 };
 
-class SplitMixHash {
+// MultiplyHash of which width is fixed at compile time.
+template <unsigned Width>
+class StaticMultiplyHash {
+    static_assert(0 < Width and Width < 64); // Range of PRIME_TABLE
+public:
+    explicit StaticMultiplyHash(unsigned width=Width) {
+        assert(width == Width);
+    }
+
+    template<unsigned K>
+    uint64_t hash(uint64_t x) const {
+        x = (x * prime<K>()) & mask();
+        return x;
+    }
+
+    template<unsigned K>
+    uint64_t ihash(uint64_t x) const {
+        x = (x * inverse_prime<K>()) & mask();
+        return x;
+    }
+
+    template<unsigned K>
+    static constexpr uint64_t prime() {return PRIME_TABLE[Width][0][K];}
+    template<unsigned K>
+    static constexpr uint64_t inverse_prime() {return PRIME_TABLE[Width][1][K];}
+    static constexpr uint64_t mask() {return Width < 64 ? (1ull<<Width)-1 : ~0ull;}
+};
+
+/* Three rounds of xorshift and multiplication.
+ * Besides hashing one key, keys of an array are hashed at once by batch of SIMD registers.
+ */
+template <class XorshiftType, class MultiplyHashType>
+class _SplitMixHash {
 private:
-    Xorshift xorshift_;
-    MultiplyHash multiply_hash_;
+    XorshiftType xorshift_;
+    MultiplyHashType multiply_hash_;
 
 public:
-    explicit SplitMixHash(unsigned width=64) :
+    _SplitMixHash() = default;
+    explicit _SplitMixHash(unsigned width) :
         xorshift_(width), multiply_hash_(width) {}
 
     uint64_t hash(uint64_t x) const {
@@ -136,22 +207,114 @@ public:
         return x;
     }
 
+    // Hash 'n' keys of 'src' into 'dst'. They may be the same array.
+    void hash(const uint64_t* src, uint64_t* dst, size_t n) const {
+        size_t i = 0;
+#if defined(__AVX512F__) && defined(__AVX512DQ__)
+        for (; i + 8 <= n; i += 8) {
+            auto x = _mm512_loadu_si512(src+i);
+            x = hash512_<0>(x);
+            x = hash512_<1>(x);
+            x = hash512_<2>(x);
+            _mm512_storeu_si512(dst+i, x);
+        }
+#elif defined(__AVX2__)
+        for (; i + 4 <= n; i += 4) {
+            auto x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src+i));
+            x = hash256_<0>(x);
+            x = hash256_<1>(x);
+            x = hash256_<2>(x);
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst+i), x);
+        }
+#endif
+        for (; i < n; i++)
+            dst[i] = hash(src[i]);
+    }
+
+    // Inverse of hash() for 'n' values of 'src' into 'dst'. They may be the same array.
+    void ihash(const uint64_t* src, uint64_t* dst, size_t n) const {
+        size_t i = 0;
+#if defined(__AVX512F__) && defined(__AVX512DQ__)
+        for (; i + 8 <= n; i += 8) {
+            auto x = _mm512_loadu_si512(src+i);
+            x = ihash512_<2>(x);
+            x = ihash512_<1>(x);
+            x = ihash512_<0>(x);
+            _mm512_storeu_si512(dst+i, x);
+        }
+#elif defined(__AVX2__)
+        for (; i + 4 <= n; i += 4) {
+            auto x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src+i));
+            x = ihash256_<2>(x);
+            x = ihash256_<1>(x);
+            x = ihash256_<0>(x);
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst+i), x);
+        }
+#endif
+        for (; i < n; i++)
+            dst[i] = ihash(src[i]);
+    }
+
 private:
     template<unsigned K>
     uint64_t hash_(uint64_t x) const {
-        x = xorshift_.hash<K>(x);
-        x = multiply_hash_.hash<K>(x);
+        x = xorshift_.template hash<K>(x);
+        x = multiply_hash_.template hash<K>(x);
         return x;
     }
 
     template<unsigned K>
     uint64_t ihash_(uint64_t x) const {
-        x = multiply_hash_.ihash<K>(x);
-        x = xorshift_.ihash<K>(x);
+        x = multiply_hash_.template ihash<K>(x);
+        x = xorshift_.template ihash<K>(x);
         return x;
     }
+
+#if defined(__AVX512F__) && defined(__AVX512DQ__)
+    template<unsigned K>
+    __m512i hash512_(__m512i x) const {
+        x = _mm512_xor_si512(x, _mm512_srli_epi64(x, xorshift_.template shift<K>()));
+        x = _mm512_mullo_epi64(x, _mm512_set1_epi64(multiply_hash_.template prime<K>()));
+        return _mm512_and_si512(x, _mm512_set1_epi64(multiply_hash_.mask()));
+    }
+
+    template<unsigned K>
+    __m512i ihash512_(__m512i x) const {
+        x = _mm512_mullo_epi64(x, _mm512_set1_epi64(multiply_hash_.template inverse_prime<K>()));
+        x = _mm512_and_si512(x, _mm512_set1_epi64(multiply_hash_.mask()));
+        return _mm512_xor_si512(x, _mm512_srli_epi64(x, xorshift_.template shift<K>()));
+    }
+#elif defined(__AVX2__)
+    // Lower 64 bits of products, composed of 32-bit multiplications.
+    static __m256i mullo256_(__m256i x, __m256i y) {
+        auto lo = _mm256_mul_epu32(x, y);
+        auto cross = _mm256_add_epi64(_mm256_mul_epu32(_mm256_srli_epi64(x, 32), y),
+                                      _mm256_mul_epu32(x, _mm256_srli_epi64(y, 32)));
+        return _mm256_add_epi64(lo, _mm256_slli_epi64(cross, 32));
+    }
+
+    template<unsigned K>
+    __m256i hash256_(__m256i x) const {
+        x = _mm256_xor_si256(x, _mm256_srli_epi64(x, xorshift_.template shift<K>()));
+        x = mullo256_(x, _mm256_set1_epi64x(multiply_hash_.template prime<K>()));
+        return _mm256_and_si256(x, _mm256_set1_epi64x(multiply_hash_.mask()));
+    }
+
+    template<unsigned K>
+    __m256i ihash256_(__m256i x) const {
+        x = mullo256_(x, _mm256_set1_epi64x(multiply_hash_.template inverse_prime<K>()));
+        x = _mm256_and_si256(x, _mm256_set1_epi64x(multiply_hash_.mask()));
+        return _mm256_xor_si256(x, _mm256_srli_epi64(x, xorshift_.template shift<K>()));
+    }
+#endif
 };
 
+using SplitMixHash = _SplitMixHash<Xorshift, MultiplyHash>;
+
+// SplitMixHash of which width is fixed at compile time, so that shifts, primes and masks are constants.
+template <unsigned Width>
+using StaticSplitMixHash = _SplitMixHash<StaticXorshift<Width>, StaticMultiplyHash<Width>>;
+
 }
 
 #endif
\ No newline at end of file
@@ -24,10 +24,33 @@ public:
         }
     }
 
+    /* Build at once from a range of values.
+     * Elements are grouped by their widths, and each table is built from its group
+     * by the bulk construction of CHT, sized exactly for the group.
+     */
     template<typename Iter>
-    explicit CDRWArray(Iter begin, Iter end) : CDRWArray(end-begin) {
-        for (auto it = begin; it != end; ++it) {
-            set(it-begin, *it);
+    explicit CDRWArray(Iter begin, Iter end) : size_(end-begin) {
+        if (size_ == 0) return;
+        auto size_bits = 64-bit_util::clz((uint64_t)size_-1);
+        widthes_ = FitVector(7, size_);
+        std::array<size_t, 64> counts{};
+        for (size_t i = 0; i < size_; i++) {
+            auto value_bits = 64-bit_util::clz((uint64_t)*(begin+i));
+            widthes_[i] = value_bits;
+            if (value_bits > 0)
+                ++counts[value_bits-1];
+        }
+        std::array<std::vector<std::pair<uint64_t, uint64_t>>, 64> groups;
+        for (int w = 0; w < 64; w++)
+            groups[w].reserve(counts[w]);
+        for (size_t i = 0; i < size_; i++) {
+            auto w = widthes_[i];
+            if (w > 0)
+                groups[w-1].emplace_back(i, *(begin+i));
+        }
+        for (int w = 0; w < 64; w++) {
+            sat_table_[w] = CHT<0>(size_bits, groups[w].begin(), groups[w].end(), w+1);
+            groups[w] = {};
         }
     }
 
@@ -46,7 +69,7 @@ public:
         auto value_bits = 64-bit_util::clz((uint64_t)value);
         auto pw = widthes_[i];
         if (pw != 0 and pw != value_bits)
-            sat_table_[pw].erase(i);
+            sat_table_[pw-1].erase(i);
         widthes_[i] = value_bits;
         if (value_bits > 0)
             sat_table_[value_bits-1].set(i, value);
@@ -54,52 +77,291 @@ public:
 
     size_t size() const { return size_; }
 
+    size_t size_in_bytes() const {
+        auto size = sizeof(size_) + widthes_.size_in_bytes();
+        for (auto& table : sat_table_)
+            size += table.size_in_bytes();
+        return size;
+    }
+
+};
+
+
+/* Compact dynamic re-writable array of which elements are grouped into blocks.
+ *
+ * Each block of kBlockSize elements has its own width w, and stores its elements in w words
+ * of the shared word pool. Elements wider than their block are marked in the overflow bitmask
+ * of the block, and are stored as whole words just after the w words in order of their indices.
+ * So get() accesses a block header and one or two words close together in the pool.
+ *
+ * When overflows of a block exceed kMaxOverflows, the block is rewritten with the width
+ * that minimizes its space. Words left by moved blocks remain as garbage in the pool
+ * until they dominate the pool, and then the pool is compacted.
+ */
+class BlockedCDRWArray {
+public:
+    static constexpr size_t kBlockSize = 64;
+    static constexpr unsigned kMaxOverflows = 8;
+
+private:
+    struct Block {
+        uint64_t offset : 57;
+        uint64_t width : 7;
+        uint64_t overflow = 0;
+        Block() : offset(0), width(0) {}
+
+        size_t num_words() const { return width + bit_util::popcnt(overflow); }
+        size_t overflow_rank(size_t j) const { return bit_util::popcnt(overflow & bit_util::WidthMask(j)); }
+    };
+
+    size_t size_ = 0;
+    std::vector<Block> blocks_;
+    std::vector<uint64_t> pool_;
+    size_t garbage_ = 0;
+
+public:
+    explicit BlockedCDRWArray(size_t size=0) :
+        size_(size),
+        blocks_((size + kBlockSize - 1) / kBlockSize) {}
+
+    template<typename Iter>
+    explicit BlockedCDRWArray(Iter begin, Iter end) : BlockedCDRWArray(end-begin) {
+        std::array<uint64_t, kBlockSize> values{};
+        for (size_t b = 0; b < blocks_.size(); b++) {
+            auto n = std::min(kBlockSize, size_t(end - begin));
+            std::copy(begin, begin + n, values.begin());
+            std::fill(values.begin() + n, values.end(), 0);
+            begin += n;
+            _write_block(b, values);
+        }
+    }
+
+    uint64_t get(size_t i) const {
+        assert(i < size());
+        auto& block = blocks_[i / kBlockSize];
+        auto j = i % kBlockSize;
+        if ((block.overflow >> j) & 1)
+            return pool_[block.offset + block.width + block.overflow_rank(j)];
+        if (block.width == 0)
+            return 0;
+        return _read_bits(pool_.data() + block.offset, j * block.width, block.width);
+    }
+
+    void set(size_t i, uint64_t value) {
+        assert(i < size());
+        auto b = i / kBlockSize;
+        auto j = i % kBlockSize;
+        auto& block = blocks_[b];
+        unsigned value_bits = 64-bit_util::clz(value);
+        bool overflowed = (block.overflow >> j) & 1;
+        if (value_bits <= block.width) {
+            if (overflowed)
+                _erase_overflow(block, j);
+            _write_bits(pool_.data() + block.offset, j * block.width, block.width, value);
+        } else if (overflowed) {
+            pool_[block.offset + block.width + block.overflow_rank(j)] = value;
+        } else if (bit_util::popcnt(block.overflow) < kMaxOverflows) {
+            _insert_overflow(block, j, value);
+        } else {
+            std::array<uint64_t, kBlockSize> values;
+            auto first = i - j;
+            for (size_t k = 0; k < kBlockSize; k++)
+                values[k] = first + k < size() ? get(first + k) : 0;
+            values[j] = value;
+            _write_block(b, values);
+        }
+    }
+
+    size_t size() const { return size_; }
+
+    size_t size_in_bytes() const {
+        return sizeof(size_) + sizeof(garbage_) + size_vec(blocks_) + size_vec(pool_);
+    }
+
+private:
+    static uint64_t _read_bits(const uint64_t* words, size_t pos, unsigned width) {
+        auto offset = pos % 64;
+        auto x = words[pos / 64] >> offset;
+        if (offset + width > 64)
+            x |= words[pos / 64 + 1] << (64 - offset);
+        return x & bit_util::WidthMask(width);
+    }
+
+    static void _write_bits(uint64_t* words, size_t pos, unsigned width, uint64_t value) {
+        if (width == 0)
+            return;
+        auto offset = pos % 64;
+        auto mask = bit_util::WidthMask(width);
+        auto& w = words[pos / 64];
+        w = (w & ~(mask << offset)) | (value << offset);
+        if (offset + width > 64) {
+            auto& nw = words[pos / 64 + 1];
+            nw = (nw & ~(mask >> (64 - offset))) | (value >> (64 - offset));
+        }
+    }
+
+    // Extend words of the block by one, moving them to the end of pool unless they are already there.
+    void _extend(Block& block) {
+        auto n = block.num_words();
+        if (block.offset + n == pool_.size()) {
+            pool_.push_back(0);
+            return;
+        }
+        auto offset = pool_.size();
+        pool_.resize(offset + n + 1);
+        std::copy(pool_.begin() + block.offset, pool_.begin() + block.offset + n, pool_.begin() + offset);
+        block.offset = offset;
+        garbage_ += n;
+    }
+
+    void _insert_overflow(Block& block, size_t j, uint64_t value) {
+        auto n = block.num_words();
+        _extend(block);
+        auto pos = block.offset + block.width + block.overflow_rank(j);
+        std::copy_backward(pool_.begin() + pos, pool_.begin() + block.offset + n, pool_.begin() + block.offset + n + 1);
+        pool_[pos] = value;
+        block.overflow |= 1ull << j;
+        _write_bits(pool_.data() + block.offset, j * block.width, block.width, 0);
+        if (garbage_ * 2 > pool_.size())
+            _compact();
+    }
+
+    void _erase_overflow(Block& block, size_t j) {
+        auto n = block.num_words();
+        auto pos = block.offset + block.width + block.overflow_rank(j);
+        std::copy(pool_.begin() + pos + 1, pool_.begin() + block.offset + n, pool_.begin() + pos);
+        block.overflow &= ~(1ull << j);
+        if (block.offset + n == pool_.size()) {
+            pool_.pop_back();
+        } else {
+            ++garbage_;
+            if (garbage_ * 2 > pool_.size())
+                _compact();
+        }
+    }
+
+    // Width minimizing space of the block, that overflows at most half of kMaxOverflows elements.
+    static unsigned _best_width(const std::array<uint64_t, kBlockSize>& values) {
+        std::array<unsigned, 65> cnt{};
+        for (auto v : values)
+            ++cnt[64-bit_util::clz(v)];
+        unsigned best = 64;
+        size_t best_cost = 64 * kBlockSize;
+        size_t exceeded = 0;
+        for (int w = 64; w >= 0; w--) {
+            if (exceeded > kMaxOverflows/2)
+                break;
+            auto cost = w * kBlockSize + exceeded * 64;
+            if (cost <= best_cost) {
+                best = w;
+                best_cost = cost;
+            }
+            exceeded += cnt[w];
+        }
+        return best;
+    }
+
+    // Rewrite the block 'b' by values with the best width.
+    void _write_block(size_t b, const std::array<uint64_t, kBlockSize>& values) {
+        auto width = _best_width(values);
+        auto& block = blocks_[b];
+        auto first = b * kBlockSize;
+        uint64_t overflow = 0;
+        for (size_t k = 0; k < kBlockSize and first + k < size(); k++) {
+            if (64u-bit_util::clz(values[k]) > width)
+                overflow |= 1ull << k;
+        }
+        garbage_ += block.num_words();
+        block = Block();
+        if (garbage_ * 2 > pool_.size())
+            _compact();
+        block.offset = pool_.size();
+        block.width = width;
+        block.overflow = overflow;
+        pool_.resize(pool_.size() + block.num_words());
+        auto exceptions = block.offset + width;
+        for (size_t k = 0; k < kBlockSize and first + k < size(); k++) {
+            if ((overflow >> k) & 1)
+                pool_[exceptions++] = values[k];
+            else
+                _write_bits(pool_.data() + block.offset, k * width, width, values[k]);
+        }
+    }
+
+    // Move words of blocks to the front of pool in order of blocks, dropping garbage.
+    void _compact() {
+        std::vector<uint64_t> next;
+        next.reserve(pool_.size() - garbage_);
+        for (auto& block : blocks_) {
+            auto offset = next.size();
+            next.insert(next.end(), pool_.begin() + block.offset, pool_.begin() + block.offset + block.num_words());
+            block.offset = offset;
+        }
+        pool_ = std::move(next);
+        garbage_ = 0;
+    }
+
 };
 
 
+/* Growable CDRWArray consisting of segments.
+ *
+ * Growth appends a new segment instead of rebuilding the whole array, so stored elements
+ * are never moved. Segments double from 2^kMinSegmentBits elements up to 2^kMaxSegmentBits,
+ * and are of fixed size 2^kMaxSegmentBits after that, which bounds the work of one push_back().
+ */
 class CDRWVector {
+public:
+    static constexpr unsigned kMinSegmentBits = 6;
+    static constexpr unsigned kMaxSegmentBits = 16;
+
 private:
     size_t size_=0;
     size_t cap_=0;
-    CDRWArray arr_;
+    std::vector<CDRWArray> segments_;
 
 public:
-    explicit CDRWVector(size_t size=0) : size_(size), cap_(size), arr_(size) {}
+    explicit CDRWVector(size_t size=0) {
+        resize(size);
+    }
 
     size_t size() const { return size_; }
 
     size_t capacity() const { return cap_; }
 
     uint64_t get(size_t i) const {
-        return arr_.get(i);
+        assert(i < size());
+        auto [s, offset] = _locate(i);
+        return segments_[s].get(offset);
     }
 
     void set(size_t i, uint64_t value) {
-        arr_.set(i, value);
+        assert(i < size());
+        auto [s, offset] = _locate(i);
+        segments_[s].set(offset, value);
     }
 
+    // Elements out of previous size are 0.
     void resize(size_t new_size) {
-        if (new_size > cap_) {
-            _allocate(std::max(new_size, cap_*2));
-        }
+        for (size_t i = new_size; i < size(); i++)
+            set(i, 0);
+        reserve(new_size);
         size_ = new_size;
     }
 
     void reserve(size_t reserved_size) {
-        if (reserved_size <= cap_)
-            return;
-        _allocate(std::max(reserved_size, cap_*2));
+        while (cap_ < reserved_size)
+            _push_segment();
     }
 
     void shrink_to_fit() {
-        if (size() == cap_)
-            return;
-        _allocate(size());
+        while (!segments_.empty() and size() <= _segment_begin(segments_.size()-1))
+            _pop_segment();
     }
 
     void push_back(uint64_t value) {
         if (size() == cap_)
-            _allocate(size()*2);
+            _push_segment();
         size_++;
         set(size()-1, value);
     }
@@ -107,26 +369,55 @@ public:
     void pop_back() {
         if (size() == 0)
             return;
-        if (size()*3 < cap_)
-            _allocate(size()*2);
+        set(size()-1, 0);
         size_--;
+        // Keep one empty segment to avoid thrashing at the boundary.
+        while (segments_.size() >= 2 and size() <= _segment_begin(segments_.size()-2))
+            _pop_segment();
     }
 
     void clear() {
         size_ = 0;
+        cap_ = 0;
+        segments_.clear();
     }
 
     bool empty() const { return size() == 0; }
 
 private:
-    void _allocate(size_t new_cap) {
-        assert(new_cap >= size());
-        assert(bit_util::popcnt(new_cap) == 1);
-        CDRWArray next(new_cap);
-        for (size_t i = 0; i < size(); i++)
-            next.set(i, get(i));
-        arr_ = next;
-        cap_ = new_cap;
+    static size_t _segment_size(size_t s) {
+        return 1ull << std::min(kMaxSegmentBits, std::max(kMinSegmentBits, unsigned(s + kMinSegmentBits - 1)));
+    }
+
+    static size_t _segment_begin(size_t s) {
+        if (s == 0)
+            return 0;
+        if (s <= kMaxSegmentBits - kMinSegmentBits + 2)
+            return 1ull << (s + kMinSegmentBits - 1);
+        return (s - (kMaxSegmentBits - kMinSegmentBits)) << kMaxSegmentBits;
+    }
+
+    // Segment and offset in it of the i-th element.
+    static std::pair<size_t, size_t> _locate(size_t i) {
+        if (i < (1ull << kMinSegmentBits))
+            return {0, i};
+        if (i < (2ull << kMaxSegmentBits)) {
+            unsigned b = 63-bit_util::clz(uint64_t(i));
+            return {b - kMinSegmentBits + 1, i - (1ull << b)};
+        }
+        return {(i >> kMaxSegmentBits) + (kMaxSegmentBits - kMinSegmentBits),
+                i & bit_util::WidthMask(kMaxSegmentBits)};
+    }
+
+    void _push_segment() {
+        auto size = _segment_size(segments_.size());
+        segments_.emplace_back(size);
+        cap_ += size;
+    }
+
+    void _pop_segment() {
+        cap_ -= _segment_size(segments_.size()-1);
+        segments_.pop_back();
     }
 
 };
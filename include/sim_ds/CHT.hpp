@@ -6,6 +6,7 @@
 #include "bit_util.hpp"
 
 #include <bitset>
+#include <functional>
 
 namespace sim_ds {
 
@@ -22,6 +23,9 @@ public:
     static constexpr uint64_t kContinuationMask = 1u << 1;
     static constexpr uint64_t kShiftedMask = 1u << 2;
     static constexpr uint64_t kDeletedMask = 1u << 3;
+    static constexpr size_t kNotFound = std::numeric_limits<size_t>::max();
+    // Number of keys hashed ahead in batch operations.
+    static constexpr size_t kBatchSize = 16;
 
 private:
     unsigned key_bits_;
@@ -37,6 +41,15 @@ private:
     size_t size_ = 0;
     size_t used_ = 0;
 
+    /* Table being drained into this one while growing or shrinking.
+     * It holds at most one table, and is kept in a vector only to keep CHT copyable.
+     * Every live key is stored in exactly one of the two tables.
+     */
+    std::vector<CHT> draining_;
+    size_t migrate_pos_ = 0;
+    size_t migrate_rest_ = 0;
+    size_t migrate_step_ = 0;
+
     bool IsOccupied(size_t i) const { return arr_[i] & kOccupiedMask; }
     bool IsContinuation(size_t i) const { return arr_[i] & kContinuationMask; }
     bool IsShifted(size_t i) const { return arr_[i] & kShiftedMask; }
@@ -54,14 +67,34 @@ public:
         bucket_mask_((1ull<<bucket_bits_)-1),
         max_size_(bucket_size*MaxLoadFactorPercent/100),
         min_size_(bucket_size*(MaxLoadFactorPercent-1)/400+1),
-        values_(ValueBits, bucket_size_),
-        hasher_(key_bits_) {
+        hasher_(key_bits_),
+        values_(ValueBits, bucket_size_) {
         assert(bit_util::popcnt(bucket_size) == 1);
         unsigned quo_bits = std::max(0, (int)key_bits - (int)bucket_bits_);
         arr_ = FitVector(quo_bits + kFlagBits, bucket_size_);
         quo_mask_ = ((1ull << quo_bits)-1) << kFlagBits;
     }
 
+    /* Build from a range of key/value pairs at once.
+     * The table is sized for the number of pairs, and clusters are laid out in a single linear pass
+     * over pairs sorted by home slot. For duplicated keys, the latter value wins.
+     */
+    template <typename ForwardIter>
+    CHT(unsigned key_bits, ForwardIter first, ForwardIter last, unsigned value_width = ValueBits) :
+        CHT(key_bits, _bucket_size_for(std::distance(first, last))) {
+        if (ValueBits == 0)
+            set_value_width(value_width);
+        std::vector<std::pair<uint64_t, uint64_t>> hvs;
+        hvs.reserve(std::distance(first, last));
+        for (; first != last; ++first) {
+            assert(64-bit_util::clz(first->first) <= key_bits_);
+            assert(64-bit_util::clz(first->second) <= values_.unit_width());
+            hvs.emplace_back(first->first, first->second);
+        }
+        _hash_keys(hvs);
+        _build(hvs);
+    }
+
     void set_value_width(unsigned width) {
         if (ValueBits != 0 or size() != 0)
             throw std::bad_function_call();
@@ -87,35 +120,316 @@ public:
 
     std::pair<bool, uint64_t> get(uint64_t key) const {
         assert(64-bit_util::clz(key) <= key_bits_);
+        return _get(hasher_.hash(key));
+    }
 
-        uint64_t initial_h = hasher_.hash(key);
-        auto quo = initial_h >> bucket_bits_;
-        size_t i = initial_h & bucket_mask_;
-        if (!IsOccupied(i))
-            return {false, 0};
-        i = ToClusterHead(i);
-        do {
-            if (Quotient(i) == quo) {
-                return {true, values_[i]};
+    /* Lookup keys of [first, last) and store results to 'out' in order.
+     * Keys are hashed group by group and their home slots are prefetched ahead of probing,
+     * so that cache misses of a group overlap.
+     */
+    template <typename KeyIter, typename OutIter>
+    void get_batch(KeyIter first, KeyIter last, OutIter out) const {
+        std::array<uint64_t, kBatchSize> hs;
+        while (first != last) {
+            size_t n = 0;
+            for (; n < kBatchSize and first != last; ++n, ++first) {
+                assert(64-bit_util::clz(*first) <= key_bits_);
+                hs[n] = *first;
             }
-            i = succ(i);
-        } while (IsContinuation(i));
-        return {false, 0};
+            hasher_.hash(hs.data(), hs.data(), n);
+            for (size_t k = 0; k < n; k++)
+                _prefetch(hs[k]);
+            for (size_t k = 0; k < n; k++)
+                *out++ = _get(hs[k]);
+        }
     }
 
     bool IsFilled() const {
-        return used_ == max_size_;
+        return used_ >= max_size_;
+    }
+
+    // Whether erasing an element might start shrinking the table.
+    bool IsSparse() const {
+        return size() <= min_size_ + 1;
     }
 
-    void set(size_t key, uint64_t value) {
-        assert(64-bit_util::clz((uint64_t)key) <= key_bits_);
+    bool migrating() const {
+        return !draining_.empty();
+    }
+
+    void set(uint64_t key, uint64_t value) {
+        assert(64-bit_util::clz(key) <= key_bits_);
         assert(64-bit_util::clz(value) <= values_.unit_width());
+        _set(hasher_.hash(key), value);
+    }
+
+    /* Insert or update pairs of keys [first, last) and values from 'value_first'.
+     * The table is sized once for the whole batch, then elements are inserted in order of
+     * their home slots so that cluster shifting walks the table sequentially.
+     * For duplicated keys, the latter value wins as repeated set() does.
+     */
+    template <typename KeyIter, typename ValueIter>
+    void set_batch(KeyIter first, KeyIter last, ValueIter value_first) {
+        std::vector<std::pair<uint64_t, uint64_t>> hvs;
+        for (; first != last; ++first, ++value_first) {
+            assert(64-bit_util::clz(*first) <= key_bits_);
+            assert(64-bit_util::clz(*value_first) <= values_.unit_width());
+            hvs.emplace_back(*first, *value_first);
+        }
+        if (hvs.empty())
+            return;
+        _hash_keys(hvs);
+        if (size() == 0 and !migrating()) {
+            // Lay out at once as the range constructor does.
+            auto width = values_.unit_width();
+            *this = CHT(key_bits_, std::max(bucket(), _bucket_size_for(hvs.size())));
+            if (ValueBits == 0)
+                set_value_width(width);
+            _build(hvs);
+            return;
+        }
+        if (migrating() or used_ + hvs.size() > max_size_)
+            reserve(size() + hvs.size());
+        _sort_by_home(hvs);
+        for (size_t k = 0; k < hvs.size(); k++) {
+            if (k + kBatchSize < hvs.size())
+                _prefetch(hvs[k + kBatchSize].first);
+            _set(hvs[k].first, hvs[k].second);
+        }
+    }
+
+    void erase(uint64_t key) {
+        assert(64-bit_util::clz(key) <= key_bits_);
+
+        auto initial_h = hasher_.hash(key);
+        if (!_erase(initial_h) and migrating())
+            draining_.front()._erase(initial_h);
+        if (migrating()) {
+            _migrate(migrate_step_);
+        } else if (size() <= min_size_) {
+            auto new_bucket_size = _bucket_size_for(size()*2);
+            if (new_bucket_size < bucket())
+                _start_migration(new_bucket_size);
+        }
+    }
+
+    size_t succ(size_t i) const {
+        i++;
+        [[unlikely]] if (i == bucket())
+            i = 0;
+        return i;
+    }
+
+    size_t pred(size_t i) const {
+        [[unlikely]] if (i == 0)
+            return bucket()-1;
+        else
+            return i-1;
+    }
+
+    void print_for_debug() const {
+        int cnt=0;
+        for (int i = 0; i < bucket(); i++) {
+            std::cout << i << "] "
+                      << bool(arr_[i]&kOccupiedMask)
+                      << bool(arr_[i]&kContinuationMask)
+                      << bool(arr_[i]&kShiftedMask)
+                      << std::endl;
+            if (IsShifted(i))
+                ++cnt;
+        }
+        std::cout<<"cnt shifted: "<<cnt<<std::endl;
+    }
+
+    // Complete migration in progress at once.
+    void complete_migration() {
+        if (migrating())
+            _migrate(migrate_rest_);
+    }
+
+    // Resize table at once. Migration in progress is completed beforehand.
+    void reserve(size_t _size) {
+        if (_size <= size())
+            return;
+        complete_migration();
+        _resize(_bucket_size_for(_size));
+    }
+
+    size_t size() const {return size_ + (migrating() ? draining_.front().size() : 0);}
+    size_t bucket() const {return bucket_size_;}
+
+    size_t size_in_bytes() const {
+        auto size = sizeof(key_bits_) + sizeof(bucket_size_) + sizeof(size_) + sizeof(used_);
+        size += arr_.size_in_bytes() + values_.size_in_bytes();
+        if (migrating())
+            size += draining_.front().size_in_bytes();
+        return size;
+    }
+
+private:
+    static size_t _bucket_size_for(size_t _size) {
+        auto need_size = _size * (100-1)/MaxLoadFactorPercent+1;
+        auto new_bucket_bits = 64-bit_util::clz((uint64_t)need_size-1);
+        return std::max(kDefaultBucketSize, size_t(1ull << new_bucket_bits));
+    }
+
+    // Hash value of the element at slot i, which is stored in run of bucket 'home'.
+    uint64_t _hash_at(size_t i, size_t home) const {
+        return (Quotient(i) << bucket_bits_) | home;
+    }
+
+    // Replace keys of pairs by their hash values, with batch hashing of kBatchSize keys.
+    void _hash_keys(std::vector<std::pair<uint64_t, uint64_t>>& hvs) const {
+        std::array<uint64_t, kBatchSize> hs;
+        for (size_t k = 0; k < hvs.size(); k += kBatchSize) {
+            auto n = std::min(kBatchSize, hvs.size()-k);
+            for (size_t j = 0; j < n; j++)
+                hs[j] = hvs[k+j].first;
+            hasher_.hash(hs.data(), hs.data(), n);
+            for (size_t j = 0; j < n; j++)
+                hvs[k+j].first = hs[j];
+        }
+    }
+
+    void _prefetch(uint64_t initial_h) const {
+        arr_.prefetch(initial_h & bucket_mask_);
+        values_.prefetch(initial_h & bucket_mask_);
+    }
+
+    /* Stable sort of hashed pairs by their home slots, and by hash values within the same home.
+     * Pairs are distributed by high bits of homes with counting sort first,
+     * then each small group is finished by insertion sort.
+     */
+    void _sort_by_home(std::vector<std::pair<uint64_t, uint64_t>>& hvs) const {
+        unsigned group_bits = std::min(bucket_bits_, 64u-bit_util::clz(uint64_t(hvs.size())));
+        unsigned shift = bucket_bits_ - group_bits;
+        std::vector<size_t> offsets((1ull<<group_bits)+1);
+        for (auto& hv : hvs)
+            ++offsets[((hv.first & bucket_mask_) >> shift) + 1];
+        std::partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+        std::vector<std::pair<uint64_t, uint64_t>> sorted(hvs.size());
+        for (auto& hv : hvs)
+            sorted[offsets[(hv.first & bucket_mask_) >> shift]++] = hv;
+        hvs = std::move(sorted);
 
-        if (IsFilled()) {
-            reserve(size()*2);
+        auto less = [&](auto& l, auto& r) {
+            auto lh = l.first & bucket_mask_, rh = r.first & bucket_mask_;
+            return lh < rh or (lh == rh and l.first < r.first);
+        };
+        size_t group_begin = 0;
+        for (auto group_end : offsets) {
+            if (group_end - group_begin > 32) {
+                std::stable_sort(hvs.begin()+group_begin, hvs.begin()+group_end, less);
+            } else {
+                for (size_t k = group_begin+1; k < group_end; k++) {
+                    auto hv = hvs[k];
+                    auto j = k;
+                    for (; j > group_begin and less(hv, hvs[j-1]); j--)
+                        hvs[j] = hvs[j-1];
+                    hvs[j] = hv;
+                }
+            }
+            group_begin = group_end;
+        }
+    }
+
+    /* Lay out hashed pairs into this empty table at once.
+     * Each run is placed at its home, or just after the previous run if it is occupied.
+     * Runs overflowing the end wrap around to the front, which pushes the runs there;
+     * the amount of wrapping is found by repeating the placement until it is stable.
+     */
+    void _build(std::vector<std::pair<uint64_t, uint64_t>>& hvs) {
+        assert(used_ == 0 and !migrating());
+        _sort_by_home(hvs);
+        size_t m = 0;
+        for (size_t k = 0; k < hvs.size(); k++) {
+            if (k+1 < hvs.size() and hvs[k+1].first == hvs[k].first)
+                continue;
+            hvs[m++] = hvs[k];
+        }
+        hvs.resize(m);
+        assert(m < bucket());
+
+        size_t wrap = 0;
+        while (true) {
+            size_t pos = wrap;
+            for (auto& hv : hvs)
+                pos = std::max(pos, size_t(hv.first & bucket_mask_)) + 1;
+            auto next_wrap = pos > bucket() ? pos - bucket() : 0;
+            if (next_wrap == wrap)
+                break;
+            wrap = next_wrap;
+        }
+        size_t pos = wrap;
+        for (size_t k = 0; k < m;) {
+            size_t home = hvs[k].first & bucket_mask_;
+            arr_[home] = arr_[home] | kOccupiedMask;
+            pos = std::max(pos, home);
+            uint64_t continuation = 0;
+            for (; k < m and (hvs[k].first & bucket_mask_) == home; k++, pos++) {
+                auto i = pos < bucket() ? pos : pos - bucket();
+                arr_[i] = (
+                    (arr_[i] & kOccupiedMask) |
+                    ((hvs[k].first >> bucket_bits_) << kFlagBits) |
+                    continuation |
+                    (pos != home ? kShiftedMask : 0)
+                );
+                values_[i] = hvs[k].second;
+                continuation = kContinuationMask;
+            }
+        }
+        size_ = used_ = m;
+    }
+
+    std::pair<bool, uint64_t> _get(uint64_t initial_h) const {
+        auto i = _find(initial_h);
+        if (i != kNotFound and !IsDeleted(i))
+            return {true, values_[i]};
+        if (migrating()) {
+            auto& src = draining_.front();
+            i = src._find(initial_h);
+            if (i != kNotFound and !src.IsDeleted(i))
+                return {true, src.values_[i]};
         }
+        return {false, 0};
+    }
+
+    void _set(uint64_t initial_h, uint64_t value) {
+        if (migrating()) {
+            // Update in place if the key has not been migrated yet.
+            auto& src = draining_.front();
+            auto i = src._find(initial_h);
+            if (i != kNotFound and !src.IsDeleted(i)) {
+                src.values_[i] = value;
+                _migrate(migrate_step_);
+                return;
+            }
+        }
+        if (IsFilled() and _find(initial_h) == kNotFound) {
+            if (migrating())
+                _migrate(migrate_rest_);
+            _start_migration(bucket()*2);
+        }
+        _insert(initial_h, value);
+        if (migrating())
+            _migrate(migrate_step_);
+    }
+
+    size_t _find(uint64_t initial_h) const {
+        auto quo = initial_h >> bucket_bits_;
+        size_t i = initial_h & bucket_mask_;
+        if (!IsOccupied(i))
+            return kNotFound;
+        i = ToClusterHead(i);
+        do {
+            if (Quotient(i) == quo)
+                return i;
+            i = succ(i);
+        } while (IsContinuation(i));
+        return kNotFound;
+    }
 
-        uint64_t initial_h = hasher_.hash(key);
+    void _insert(uint64_t initial_h, uint64_t value) {
         auto quo = initial_h >> bucket_bits_;
         size_t initial_i = initial_h & bucket_mask_;
         auto i = ToClusterHead(initial_i);
@@ -140,8 +454,8 @@ public:
             do {
                 auto pj = pred(j);
                 arr_[j] = (
-                    (arr_[j] & (kOccupiedMask|kDeletedMask)) |
-                    (arr_[pj] & (quo_mask_|kContinuationMask)) |
+                    (arr_[j] & kOccupiedMask) |
+                    (arr_[pj] & (quo_mask_|kContinuationMask|kDeletedMask)) |
                     kShiftedMask
                 );
                 values_[j] = values_[pj];
@@ -169,73 +483,84 @@ public:
         values_[i] = value;
     }
 
-    void erase(uint64_t key) {
-        if (size() == min_size_) {
-            reserve(size()*2);
-        }
-
-        auto initial_h = hasher_.hash(key);
-        auto quo = initial_h / bucket_bits_;
-        auto initial_i = initial_h & bucket_mask_;
-        if (!IsOccupied(initial_i))
-            return;
-        auto i = ToClusterHead(initial_i);
-        do {
-            if (Quotient(i) == quo) {
-                if (!IsDeleted(i)) {
-                    arr_[i] = arr_[i] | kDeletedMask;
-                    size_--;
-                }
-                return;
-            }
-            i = succ(i);
-        } while (IsContinuation(i));
+    bool _erase(uint64_t initial_h) {
+        auto i = _find(initial_h);
+        if (i == kNotFound or IsDeleted(i))
+            return false;
+        arr_[i] = arr_[i] | kDeletedMask;
+        size_--;
+        return true;
     }
 
-    size_t succ(size_t i) const {
-        i++;
-        [[unlikely]] if (i == bucket())
-            i = 0;
-        return i;
-    }
-
-    size_t pred(size_t i) const {
-        [[unlikely]] if (i == 0)
-            return bucket()-1;
-        else
-            return i-1;
+    /* Start to drain current elements into a new table.
+     * Each update operation moves the following clusters of at least migrate_step_ slots,
+     * which is enough to complete migration before the new table is filled.
+     */
+    void _start_migration(size_t new_bucket_size) {
+        assert(!migrating());
+        CHT next(key_bits_, new_bucket_size);
+        if (ValueBits == 0)
+            next.set_value_width(values_.unit_width());
+        // Migration starts at an empty slot so that no cluster is split.
+        size_t e = 0;
+        while (!IsNull(e))
+            ++e;
+        auto headroom = next.max_size_ > size_ ? next.max_size_ - size_ : 1;
+        next.migrate_pos_ = e;
+        next.migrate_rest_ = bucket();
+        next.migrate_step_ = bucket() / headroom + 1;
+        next.draining_.push_back(std::move(*this));
+        *this = std::move(next);
     }
 
-    void print_for_debug() const {
-        int cnt=0;
-        for (int i = 0; i < bucket(); i++) {
-            std::cout << i << "] "
-                      << bool(arr_[i]&kOccupiedMask)
-                      << bool(arr_[i]&kContinuationMask)
-                      << bool(arr_[i]&kShiftedMask)
-                      << std::endl;
-            if (IsShifted(i))
+    /* Move clusters of the draining table until at least 'step' slots are scanned.
+     * Tombstones are dropped on the way, and moved slots are cleared in the draining table
+     * so that it stays consistent for lookups.
+     */
+    void _migrate(size_t step) {
+        auto& src = draining_.front();
+        size_t scanned = 0;
+        std::queue<size_t> homes;
+        while (migrate_rest_ > 0 and scanned < step) {
+            auto head = migrate_pos_;
+            if (src.IsNull(head)) {
+                migrate_pos_ = src.succ(head);
+                --migrate_rest_;
+                ++scanned;
+                continue;
+            }
+            size_t i = head;
+            size_t home = head;
+            size_t cnt = 0;
+            do {
+                if (src.IsOccupied(i))
+                    homes.push(i);
+                if (!src.IsContinuation(i)) {
+                    assert(!homes.empty());
+                    home = homes.front();
+                    homes.pop();
+                }
+                if (!src.IsDeleted(i)) {
+                    _insert(src._hash_at(i, home), src.values_[i]);
+                    src.size_--;
+                }
                 ++cnt;
+                i = src.succ(i);
+            } while (src.IsShifted(i));
+            for (auto j = head; j != i; j = src.succ(j))
+                src.arr_[j] = 0;
+            src.used_ -= cnt;
+            migrate_pos_ = i;
+            migrate_rest_ -= cnt;
+            scanned += cnt;
         }
-        std::cout<<"cnt shifted: "<<cnt<<std::endl;
+        if (migrate_rest_ == 0)
+            draining_.clear();
     }
 
-    void reserve(size_t _size) {
-        if (_size <= size())
-            return;
-        auto need_size = _size * (100-1)/MaxLoadFactorPercent+1;
-        auto new_bucket_bits = 64-bit_util::clz((uint64_t)need_size-1);
-        _resize(1ull << new_bucket_bits);
-    }
-    
-    size_t size() const {return size_;}
-    size_t bucket() const {return bucket_size_;}
-
-private:
     void _resize(size_t new_bucket_size) {
-        CHT next(key_bits_, new_bucket_size);
-        if (ValueBits == 0)
-            next.set_value_width(values_.unit_width());
+        std::vector<std::pair<uint64_t, uint64_t>> hvs;
+        hvs.reserve(size_);
         size_t i = 0;
         size_t cnt = 0;
         while (cnt < used_) {
@@ -254,15 +579,17 @@ private:
                     qs.pop();
                 }
                 if (!IsDeleted(i)) {
-                    uint64_t x = (Quotient(i) << bucket_bits_) | f;
-                    x = hasher_.ihash(x);
-                    next.set(x, values_[i]);
+                    hvs.emplace_back(_hash_at(i, f), values_[i]);
                 }
                 cnt++;
                 i = succ(i);
             } while (IsShifted(i));
         }
-        *this = next;
+        CHT next(key_bits_, new_bucket_size);
+        if (ValueBits == 0)
+            next.set_value_width(values_.unit_width());
+        next._build(hvs);
+        *this = std::move(next);
     }
 
 };
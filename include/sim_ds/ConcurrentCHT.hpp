@@ -0,0 +1,176 @@
+#ifndef SIDS_INCLUDE_SIM_DS_CONCURRENTCHT_H_
+#define SIDS_INCLUDE_SIM_DS_CONCURRENTCHT_H_
+
+#include "CHT.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+namespace sim_ds {
+
+/* Compact hash table shared by threads for read-mostly workloads.
+ *
+ * Keys are distributed to segments by their hash. Each segment is a CHT guarded by a seqlock:
+ * get() never takes a lock but retries while a writer updates the same segment,
+ * and writers are serialized by a mutex per segment.
+ *
+ * Updates that restructure a segment (growth or shrink) are done on a copy of the table,
+ * which is published by swapping the table pointer. Replaced tables are retired rather than freed
+ * since readers may still be traversing them, and are released by reclaim() or destruction.
+ */
+template <
+    unsigned ValueBits,
+    unsigned MaxLoadFactorPercent = 50,
+    typename BijectiveHash = SplitMixHash>
+class ConcurrentCHT {
+public:
+    using table_type = CHT<ValueBits, MaxLoadFactorPercent, BijectiveHash>;
+    static constexpr unsigned kDefaultSegmentBits = 6;
+
+private:
+    struct alignas(64) Segment {
+        std::atomic<uint64_t> version{0};
+        std::atomic<table_type*> table{nullptr};
+        std::atomic<size_t> size{0};
+        std::mutex mutex;
+        std::vector<std::unique_ptr<table_type>> retired;
+    };
+
+    unsigned key_bits_;
+    unsigned segment_bits_;
+    BijectiveHash hasher_;
+    std::unique_ptr<Segment[]> segments_;
+
+public:
+    explicit ConcurrentCHT(unsigned key_bits,
+                           unsigned value_width = ValueBits,
+                           unsigned segment_bits = kDefaultSegmentBits) :
+        key_bits_(key_bits),
+        segment_bits_(std::min(segment_bits, key_bits)),
+        hasher_(key_bits),
+        segments_(new Segment[1ull << segment_bits_]) {
+        for (size_t s = 0; s < num_segments(); s++) {
+            auto table = std::make_unique<table_type>(key_bits_);
+            if (ValueBits == 0)
+                table->set_value_width(value_width);
+            segments_[s].table.store(table.get(), std::memory_order_relaxed);
+            segments_[s].retired.push_back(std::move(table));
+        }
+    }
+
+    ConcurrentCHT(const ConcurrentCHT&) = delete;
+    ConcurrentCHT& operator=(const ConcurrentCHT&) = delete;
+
+    std::pair<bool, uint64_t> get(uint64_t key) const {
+        auto& seg = _segment(key);
+        while (true) {
+            auto v = seg.version.load(std::memory_order_acquire);
+            if (v & 1) {
+                std::this_thread::yield();
+                continue;
+            }
+            auto res = seg.table.load(std::memory_order_acquire)->get(key);
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (seg.version.load(std::memory_order_relaxed) == v)
+                return res;
+        }
+    }
+
+    void set(uint64_t key, uint64_t value) {
+        auto& seg = _segment(key);
+        std::lock_guard<std::mutex> lock(seg.mutex);
+        auto* table = seg.table.load(std::memory_order_relaxed);
+        if (table->IsFilled() and !table->get(key).first) {
+            auto next = std::make_unique<table_type>(*table);
+            // Rebuilt even when filled only by tombstones, so that set() does not start migration.
+            next->reserve(std::max<size_t>(table->size()*2, table->size()+1));
+            next->set(key, value);
+            _publish(seg, std::move(next));
+        } else {
+            _write_begin(seg);
+            table->set(key, value);
+            _write_end(seg);
+        }
+        seg.size.store(seg.table.load(std::memory_order_relaxed)->size(), std::memory_order_relaxed);
+    }
+
+    void erase(uint64_t key) {
+        auto& seg = _segment(key);
+        std::lock_guard<std::mutex> lock(seg.mutex);
+        auto* table = seg.table.load(std::memory_order_relaxed);
+        if (!table->get(key).first)
+            return;
+        // Only an erase that starts shrinking is done on a copy. Tables of the default bucket never shrink.
+        if (table->IsSparse() and table->bucket() > table_type::kDefaultBucketSize) {
+            auto next = std::make_unique<table_type>(*table);
+            next->erase(key);
+            next->complete_migration();
+            _publish(seg, std::move(next));
+        } else {
+            _write_begin(seg);
+            table->erase(key);
+            _write_end(seg);
+        }
+        seg.size.store(seg.table.load(std::memory_order_relaxed)->size(), std::memory_order_relaxed);
+    }
+
+    // Number of elements. It is exact only while no writer is running.
+    size_t size() const {
+        size_t sum = 0;
+        for (size_t s = 0; s < num_segments(); s++)
+            sum += segments_[s].size.load(std::memory_order_relaxed);
+        return sum;
+    }
+
+    size_t num_segments() const {return 1ull << segment_bits_;}
+
+    /* Release retired tables.
+     * It must be called when no other thread is accessing this table.
+     */
+    void reclaim() {
+        for (size_t s = 0; s < num_segments(); s++) {
+            auto& seg = segments_[s];
+            std::lock_guard<std::mutex> lock(seg.mutex);
+            auto* table = seg.table.load(std::memory_order_relaxed);
+            auto it = std::find_if(seg.retired.begin(), seg.retired.end(), [&](auto& t) {
+                return t.get() == table;
+            });
+            auto current = std::move(*it);
+            seg.retired.clear();
+            seg.retired.push_back(std::move(current));
+        }
+    }
+
+private:
+    Segment& _segment(uint64_t key) const {
+        assert(64-bit_util::clz(key) <= key_bits_);
+        return segments_[hasher_.hash(key) >> (key_bits_ - segment_bits_)];
+    }
+
+    static void _write_begin(Segment& seg) {
+        seg.version.store(seg.version.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+    }
+
+    static void _write_end(Segment& seg) {
+        seg.version.store(seg.version.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+    // Published tables must not be migrating, since in-place updates would free the draining table
+    // under readers.
+    static void _publish(Segment& seg, std::unique_ptr<table_type>&& next) {
+        assert(!next->migrating());
+        _write_begin(seg);
+        seg.table.store(next.get(), std::memory_order_release);
+        seg.retired.push_back(std::move(next));
+        _write_end(seg);
+    }
+
+};
+
+}
+
+#endif //SIDS_INCLUDE_SIM_DS_CONCURRENTCHT_H_
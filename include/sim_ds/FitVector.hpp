@@ -153,6 +153,11 @@ public:
     
     // MARK: method
     
+    // Hint to load the word containing element at 'index' into cache.
+    void prefetch(size_t index) const {
+        __builtin_prefetch(storage_.data() + abs_(index));
+    }
+    
     size_t size_in_bytes() const {
         auto size = sizeof(bits_per_element_) + sizeof(size_);
         size += size_vec(storage_);
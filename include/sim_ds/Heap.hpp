@@ -13,116 +13,349 @@
 
 #include "basic.hpp"
 
+#include <functional>
+
 namespace sim_ds {
 
-template <bool Ascending = true>
-class Heap {
+/* d-ary heap of values of type T.
+ * compare(l, r) returns whether l is prior to r, so std::less makes a min-heap.
+ *
+ * Nodes are indexed from root() = 1, and children of a node are consecutive.
+ * Storage is padded so that the children of each node start at a multiple of Arity,
+ * thus Arity * sizeof(T) = 64 places siblings in one cache line.
+ */
+template <typename T, class Compare = std::less<T>, unsigned Arity = 4>
+class DaryHeap {
+    static_assert(Arity >= 2);
 public:
-    Heap() = default;
-    
-    template <typename T>
-    Heap(const std::vector<T> array) {
-        base_.reserve(array.size());
-        for (auto v : array) {
-            base_.push_back(v);
-        }
-        Build();
-    }
-    
+    using value_type = T;
+    static constexpr unsigned kArity = Arity;
+    static constexpr size_t kPadding = Arity - 1;
+
+private:
+    aligned_vector<T, 64> base_;
+    Compare compare_;
+
+public:
+    explicit DaryHeap(Compare compare = Compare()) : base_(kPadding), compare_(compare) {}
+
+    template <typename U>
+    DaryHeap(const std::vector<U>& array) : DaryHeap(array.begin(), array.end()) {}
+
     template <class Iterator>
-    explicit Heap(Iterator begin, Iterator end) {
-        base_.reserve(end - begin);
+    explicit DaryHeap(Iterator begin, Iterator end, Compare compare = Compare()) : DaryHeap(compare) {
+        base_.reserve(kPadding + (end - begin));
         while (begin < end) {
             base_.push_back(*begin);
             ++begin;
         }
         Build();
     }
-    
+
+    // Sift down the value at node id.
     void Heapify(size_t id) {
-        if (is_leaf(id))
-            return;
-        auto l = left(id);
-        auto min_i = l;
-        auto r = right(id);
-        if (r <= size()) {
-            if (!Compare(value(l), value(r))) {
-                min_i = r;
+        T x = std::move(value_reference(id));
+        while (true) {
+            auto c = child(id, 0);
+            if (c > size())
+                break;
+            auto last = std::min(c + Arity - 1, size());
+            auto best = c;
+            for (auto k = c + 1; k <= last; k++) {
+                if (compare_(value(k), value(best)))
+                    best = k;
             }
+            if (!compare_(value(best), x))
+                break;
+            value_reference(id) = std::move(value_reference(best));
+            id = best;
         }
-        if (!Compare(value(id), value(min_i))) {
-            std::swap(base_[id - 1], base_[min_i - 1]);
-            Heapify(min_i);
+        value_reference(id) = std::move(x);
+    }
+
+    // Sift up the value at node id.
+    void SiftUp(size_t id) {
+        T x = std::move(value_reference(id));
+        while (id > root()) {
+            auto p = parent(id);
+            if (!compare_(x, value(p)))
+                break;
+            value_reference(id) = std::move(value_reference(p));
+            id = p;
         }
+        value_reference(id) = std::move(x);
     }
-    
+
     void Build() {
-        for (size_t i = size() / 2; i > 0; i--) {
+        if (size() < 2)
+            return;
+        for (size_t i = parent(size()); i > 0; i--) {
             Heapify(i);
         }
     }
-    
-    void push(id_type value) {
-        base_.insert(base_.begin(), value);
-        Heapify(root());
+
+    void push(T value) {
+        base_.push_back(std::move(value));
+        SiftUp(size());
     }
-    
+
+    /* Move the hole at root down to a leaf along prior children, then sift up the last value into it.
+     * The last value mostly belongs near leaves, so this saves comparisons against it on the way down.
+     */
     void pop() {
-        std::swap(base_.front(), base_.back());
-        base_.resize(base_.size() - 1);
-        Heapify(root());
+        assert(!empty());
+        T x = std::move(base_.back());
+        base_.pop_back();
+        if (empty())
+            return;
+        size_t id = root();
+        while (true) {
+            auto c = child(id, 0);
+            if (c > size())
+                break;
+            auto last = std::min(c + Arity - 1, size());
+            auto best = c;
+            for (auto k = c + 1; k <= last; k++) {
+                if (compare_(value(k), value(best)))
+                    best = k;
+            }
+            value_reference(id) = std::move(value_reference(best));
+            id = best;
+        }
+        value_reference(id) = std::move(x);
+        SiftUp(id);
     }
-    
-    id_type value(size_t id) const {
+
+    const T& value(size_t id) const {
         assert(id > 0 && id <= size());
-        return base_[id - 1];
+        return base_[kPadding + id - 1];
     }
-    
-    id_type& value_reference(size_t id) {
+
+    T& value_reference(size_t id) {
         assert(id > 0 && id <= size());
-        return base_[id - 1];
+        return base_[kPadding + id - 1];
     }
-    
-    id_type front() const {
-        return base_.front();
+
+    const T& front() const {
+        return value(root());
+    }
+
+    const T& top() const {
+        return front();
     }
-    
+
     size_t root() const {
         return 1;
     }
-    
+
     size_t parent(size_t id) const {
-        return id / 2;
+        return (id - 2) / Arity + 1;
+    }
+
+    // k-th child of node id.
+    size_t child(size_t id, size_t k) const {
+        return Arity * (id - 1) + 2 + k;
     }
-    
+
     size_t left(size_t id) const {
-        return 2 * id;
+        return child(id, 0);
     }
-    
+
     bool is_leaf(size_t id) const {
-        return id > (size() / 2);
+        return child(id, 0) > size();
     }
-    
+
     size_t right(size_t id) const {
-        return 2 * id + 1;
+        return child(id, 1);
     }
-    
+
     size_t size() const {
-        return base_.size();
+        return base_.size() - kPadding;
     }
-    
-private:
-    std::vector<id_type> base_;
-    
-    bool Compare(id_type l, id_type r) {
-        return Ascending ? l < r : l > r;
+
+    bool empty() const {
+        return size() == 0;
+    }
+
+    void clear() {
+        base_.resize(kPadding);
     }
-    
+
 };
 
+template <bool Ascending = true>
+using Heap = DaryHeap<id_type, std::conditional_t<Ascending, std::less<id_type>, std::greater<id_type>>, 2>;
+
 using MinHeap = Heap<true>;
 using MaxHeap = Heap<false>;
 
+
+/* d-ary heap of ids in [0, capacity) with keys, supporting to update keys of ids in heap.
+ * Nodes hold both of key and id so that sifting does not refer to other arrays,
+ * and positions of ids are tracked to find their nodes.
+ */
+template <typename Key, class Compare = std::less<Key>, unsigned Arity = 4>
+class IndexedHeap {
+    static_assert(Arity >= 2);
+public:
+    using key_type = Key;
+    static constexpr size_t kPadding = Arity - 1;
+    static constexpr size_t kNotInHeap = std::numeric_limits<size_t>::max();
+
+private:
+    struct Node {
+        Key key;
+        size_t id;
+    };
+
+    aligned_vector<Node, 64> base_;
+    std::vector<size_t> pos_;
+    Compare compare_;
+
+public:
+    explicit IndexedHeap(size_t capacity = 0, Compare compare = Compare()) :
+        base_(kPadding), pos_(capacity, kNotInHeap), compare_(compare) {}
+
+    void push(size_t id, Key key) {
+        assert(id < capacity());
+        assert(!contains(id));
+        base_.push_back({std::move(key), id});
+        pos_[id] = size();
+        _sift_up(size());
+    }
+
+    void pop() {
+        assert(!empty());
+        erase(top_id());
+    }
+
+    void erase(size_t id) {
+        assert(contains(id));
+        auto p = pos_[id];
+        pos_[id] = kNotInHeap;
+        if (p == size()) {
+            base_.pop_back();
+            return;
+        }
+        _node(p) = std::move(base_.back());
+        base_.pop_back();
+        auto moved_id = _node(p).id;
+        pos_[moved_id] = p;
+        // The moved node goes either up or down.
+        _sift_up(p);
+        _sift_down(pos_[moved_id]);
+    }
+
+    // Change key of id in heap, either prior or posterior to current one.
+    void update(size_t id, Key key) {
+        assert(contains(id));
+        auto p = pos_[id];
+        bool prior = compare_(key, _node(p).key);
+        _node(p).key = std::move(key);
+        if (prior)
+            _sift_up(p);
+        else
+            _sift_down(p);
+    }
+
+    void decrease_key(size_t id, Key key) {
+        assert(contains(id));
+        assert(!compare_(_node(pos_[id]).key, key));
+        auto p = pos_[id];
+        _node(p).key = std::move(key);
+        _sift_up(p);
+    }
+
+    // Push id, or update its key if it is already in heap.
+    void push_or_update(size_t id, Key key) {
+        if (contains(id))
+            update(id, std::move(key));
+        else
+            push(id, std::move(key));
+    }
+
+    bool contains(size_t id) const {
+        return id < pos_.size() and pos_[id] != kNotInHeap;
+    }
+
+    const Key& key(size_t id) const {
+        assert(contains(id));
+        return _node(pos_[id]).key;
+    }
+
+    size_t top_id() const {
+        return _node(1).id;
+    }
+
+    const Key& top_key() const {
+        return _node(1).key;
+    }
+
+    size_t size() const {
+        return base_.size() - kPadding;
+    }
+
+    bool empty() const {
+        return size() == 0;
+    }
+
+    size_t capacity() const {
+        return pos_.size();
+    }
+
+    void clear() {
+        for (size_t p = 1; p <= size(); p++)
+            pos_[_node(p).id] = kNotInHeap;
+        base_.resize(kPadding);
+    }
+
+private:
+    Node& _node(size_t p) {
+        return base_[kPadding + p - 1];
+    }
+
+    const Node& _node(size_t p) const {
+        return base_[kPadding + p - 1];
+    }
+
+    void _sift_up(size_t p) {
+        Node x = std::move(_node(p));
+        while (p > 1) {
+            auto pp = (p - 2) / Arity + 1;
+            if (!compare_(x.key, _node(pp).key))
+                break;
+            _node(p) = std::move(_node(pp));
+            pos_[_node(p).id] = p;
+            p = pp;
+        }
+        pos_[x.id] = p;
+        _node(p) = std::move(x);
+    }
+
+    void _sift_down(size_t p) {
+        Node x = std::move(_node(p));
+        while (true) {
+            auto c = Arity * (p - 1) + 2;
+            if (c > size())
+                break;
+            auto last = std::min(c + Arity - 1, size());
+            auto best = c;
+            for (auto k = c + 1; k <= last; k++) {
+                if (compare_(_node(k).key, _node(best).key))
+                    best = k;
+            }
+            if (!compare_(_node(best).key, x.key))
+                break;
+            _node(p) = std::move(_node(best));
+            pos_[_node(p).id] = p;
+            p = best;
+        }
+        pos_[x.id] = p;
+        _node(p) = std::move(x);
+    }
+
+};
+
 }
 
 #endif /* Heap_hpp */
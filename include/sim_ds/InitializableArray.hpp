@@ -7,6 +7,8 @@
 #include <numeric>
 #include <type_traits>
 
+#include "FitVector.hpp"
+
 namespace sim_ds {
 
 template <typename T>
@@ -53,6 +55,13 @@ public:
     
     size_t size() const {return fv_.size();}
     
+    // Apply action(index, value) to elements set after the last initialization, in order of setting.
+    template <class Action>
+    void for_each(Action action) const {
+        for (auto index : t_)
+            action(index, fv_[index].second);
+    }
+    
 private:
     bool _is_chained(size_t index) const {
         auto f = fv_[index].first;
@@ -62,6 +71,272 @@ private:
 };
 
 
+/* Folklore initializable array of which chain holds values.
+ * Elements keep only back-pointers of IndexType to the chain, and each entry of the chain
+ * packs the index and the value. So get() touches a back-pointer and an entry,
+ * and scanning set elements walks the chain sequentially.
+ * Size beyond the range of IndexType is rejected, for which IndexType of uint64_t is required.
+ */
+template <typename T, typename IndexType = uint32_t>
+class CompactInitializableArrayFolklore {
+public:
+    using value_type = T;
+    using index_type = IndexType;
+private:
+    struct Entry {
+        index_type index;
+        T value;
+    };
+
+    T init_v_;
+    std::vector<index_type> back_;
+    std::vector<Entry> chain_;
+
+public:
+    explicit CompactInitializableArrayFolklore(size_t size = 0, T val = T()) : init_v_(val) {
+        static_assert(std::is_unsigned_v<index_type>);
+        if (size > 0 and size-1 > std::numeric_limits<index_type>::max())
+            throw std::length_error("CompactInitializableArrayFolklore: size exceeds the range of IndexType.");
+        back_.resize(size);
+    }
+
+    template <typename It>
+    explicit CompactInitializableArrayFolklore(It begin, It end) : CompactInitializableArrayFolklore(end - begin) {
+        static_assert(std::is_convertible_v<typename std::iterator_traits<It>::value_type, T>);
+        for (auto it = begin; it != end; ++it) {
+            set(it-begin, *it);
+        }
+    }
+
+    T get(size_t index) const {
+        auto f = back_[index];
+        return f < chain_.size() and chain_[f].index == index ? chain_[f].value : init_v_;
+    }
+
+    void set(size_t index, T val) {
+        auto f = back_[index];
+        if (f < chain_.size() and chain_[f].index == index) {
+            chain_[f].value = val;
+        } else {
+            back_[index] = chain_.size();
+            chain_.push_back({index_type(index), val});
+        }
+    }
+
+    // Initialize all values in O(1) time operation
+    void init(T init_v=T()) {
+        init_v_ = init_v;
+        chain_.clear();
+    }
+
+    void fill(T init_v=T()) {
+        init(init_v);
+    }
+
+    size_t size() const {return back_.size();}
+
+    // Number of elements set after the last initialization.
+    size_t num_set() const {return chain_.size();}
+
+    // Apply action(index, value) to elements set after the last initialization, in order of setting.
+    template <class Action>
+    void for_each(Action action) const {
+        for (auto& e : chain_)
+            action(size_t(e.index), e.value);
+    }
+
+};
+
+
+
+/* In-Place Initializable Array of runtime size, storing values of 'width' bits in FitVector.
+ * Katoh T, Goto K. In-Place Initializable Arrays. http://arxiv.org/abs/1709.08900
+ *
+ * Consecutive elements are packed into cells wide enough to hold an index of cells,
+ * and the algorithm of the special case works on the cells.
+ * So it takes only O(1) words besides n * width bits of the values (general case).
+ */
+class InitializableFitVector {
+public:
+    using value_type = uint64_t;
+private:
+    size_t size_;
+    unsigned width_;
+    unsigned per_cell_;
+    uint64_t init_v_;
+    uint64_t init_cell_;
+    size_t b_;
+    size_t none_block_;
+    FitVector cells_;
+
+public:
+    explicit InitializableFitVector(size_t size = 0, unsigned width = 64, uint64_t init_v = 0) :
+        size_(size), width_(width), per_cell_(1), b_(0) {
+        assert(0 < width and width <= 64);
+        size_t num_cells = 0;
+        unsigned cell_width = width;
+        while (true) {
+            num_cells = (size + per_cell_ - 1) / per_cell_;
+            num_cells += num_cells % 2;
+            unsigned index_bits = std::max(1, 64-bit_util::clz(uint64_t(std::max<size_t>(num_cells, 1)-1)));
+            if (per_cell_ * width >= index_bits) {
+                cell_width = per_cell_ * width;
+                break;
+            }
+            if ((per_cell_ + 1) * width > 64) {
+                // Cells can not be packed, then pad each element.
+                per_cell_ = 1;
+                num_cells = size + size % 2;
+                cell_width = std::max(width, unsigned(64-bit_util::clz(uint64_t(std::max<size_t>(num_cells, 1)-1))));
+                break;
+            }
+            ++per_cell_;
+        }
+        none_block_ = num_cells / 2;
+        cells_ = FitVector(cell_width, num_cells);
+        init(init_v);
+    }
+
+    uint64_t get(size_t i) const {
+        assert(i < size());
+        auto cell = _get_cell(i / per_cell_);
+        return (cell >> (i % per_cell_ * width_)) & bit_util::WidthMask(width_);
+    }
+
+    void set(size_t i, uint64_t val) {
+        assert(i < size());
+        assert(val <= bit_util::WidthMask(width_));
+        auto shift = i % per_cell_ * width_;
+        auto cell = per_cell_ == 1 ? 0 : _get_cell(i / per_cell_);
+        cell = (cell & ~(bit_util::WidthMask(width_) << shift)) | (val << shift);
+        _set_cell(i / per_cell_, cell);
+    }
+
+    // Initialize all values in O(1) time operation
+    void init(uint64_t init_v = 0) {
+        init_v_ = init_v & bit_util::WidthMask(width_);
+        init_cell_ = 0;
+        for (unsigned k = 0; k < per_cell_; k++)
+            init_cell_ |= init_v_ << (k * width_);
+        b_ = 0;
+    }
+
+    void fill(uint64_t init_v = 0) {
+        init(init_v);
+    }
+
+    size_t size() const {return size_;}
+
+    unsigned unit_width() const {return width_;}
+
+    size_t size_in_bytes() const {
+        return sizeof(size_) + sizeof(width_) + sizeof(per_cell_) + sizeof(init_v_) + sizeof(init_cell_) +
+               sizeof(b_) + sizeof(none_block_) + cells_.size_in_bytes();
+    }
+
+private:
+    uint64_t _get_cell(size_t i) const {
+        auto b = i/2;
+        auto k = _chained_to(b);
+        if (i < 2*b_) { // Unwritten Chained Area
+            return k != none_block_ ? init_cell_ : cells_[i];
+        } else { // Written Chained Area
+            if (k != none_block_) {
+                return i%2==0 ? cells_[cells_[i]+1] : cells_[i];
+            } else {
+                return init_cell_;
+            }
+        }
+    }
+
+    void _set_cell(const size_t i, uint64_t val) {
+        const auto b = i/2;
+        auto k = _chained_to(b);
+        auto write_uca = [&]() {
+            cells_[i] = val;
+            _break_chain(b);
+        };
+        if (b < b_) { // Unwritten Chained Area
+            if (k == none_block_) {
+                write_uca();
+            } else {
+                auto j = _extend();
+                if (b == j) {
+                    write_uca();
+                } else {
+                    cells_[2*j] = cells_[2*b];
+                    cells_[2*j+1] = cells_[2*b+1];
+                    _make_chain(j, k);
+                    _init_block(b);
+                    write_uca();
+                }
+            }
+        } else { // Written Chained Area
+            auto write_wca = [&]() {
+                if (i%2==0)
+                    cells_[2*k+1] = val;
+                else
+                    cells_[i] = val;
+            };
+            if (k != none_block_) {
+                write_wca();
+            } else {
+                k = _extend();
+                if (b == k) {
+                    write_uca();
+                } else {
+                    _init_block(b);
+                    _make_chain(k, b);
+                    write_wca();
+                }
+            }
+        }
+    }
+
+    size_t _chained_to(size_t b) const {
+        size_t bki = cells_[2 * b];
+        if (bki < cells_.size() and bki % 2 == 0 and cells_[bki] == 2 * b and
+            ((b < b_ and b_ <= bki / 2) or (bki / 2 < b_ and b_ <= b)))
+            return bki/2;
+        else
+            return none_block_;
+    }
+
+    void _make_chain(size_t bi, size_t bj) {
+        assert(bi < b_ and b_ <= bj);
+        cells_[2*bi] = 2*bj;
+        cells_[2*bj] = 2*bi;
+    }
+
+    void _break_chain(size_t b) {
+        auto bk = _chained_to(b);
+        if (bk != none_block_){
+            cells_[2*bk] = 2*bk;
+        }
+    }
+
+    void _init_block(size_t b) {
+        cells_[2*b] = init_cell_;
+        cells_[2*b+1] = init_cell_;
+    }
+
+    size_t _extend() {
+        auto k = _chained_to(b_);
+        b_++;
+        if (k == none_block_) {
+            k = b_-1;
+        } else {
+            cells_[2*(b_-1)] = cells_[2*k+1];
+            _break_chain(b_-1);
+        }
+        _init_block(k);
+        _break_chain(k);
+        return k;
+    }
+
+};
+
+
 
 // Katoh T, Goto K. In-Place Initializable Arrays. http://arxiv.org/abs/1709.08900
 template<typename T, size_t Size,
@@ -71,7 +346,8 @@ class _InitializableArray;
 
 template <typename T, size_t Size>
 using InitializableArray = _InitializableArray<T, Size,
-    (1ull<<(std::numeric_limits<T>::digits)) >= (Size+(Size%2))>;
+    (std::numeric_limits<T>::digits >= 64 or
+     (1ull<<(std::numeric_limits<T>::digits)) >= (Size+(Size%2)))>;
 
 
 // In-Place Initializable Arrays for a Special Case
@@ -301,8 +577,81 @@ public:
 
 
 // In-Place Initializable Arrays for a General Case
+// bool is packed in 1 bit (e.g. visited marks), and other trivially copyable types of up to 8 bytes
+// are stored by their bytes.
 template <typename T, size_t Size>
-class _InitializableArray<T, Size, false> {};
+class _InitializableArray<T, Size, false> {
+    static_assert(std::is_trivially_copyable_v<T> and sizeof(T) <= 8);
+public:
+    using value_type = T;
+    static constexpr unsigned kBits = std::is_same_v<T, bool> ? 1 : sizeof(T) * 8;
+private:
+    InitializableFitVector arr_;
+
+    static uint64_t _to_bits(T val) {
+        if constexpr (std::is_same_v<T, bool>) {
+            return val;
+        } else if constexpr (std::is_integral_v<T>) {
+            return static_cast<std::make_unsigned_t<T>>(val);
+        } else {
+            uint64_t bits = 0;
+            std::memcpy(&bits, &val, sizeof(T));
+            return bits;
+        }
+    }
+
+    static T _from_bits(uint64_t bits) {
+        if constexpr (std::is_same_v<T, bool>) {
+            return bits != 0;
+        } else if constexpr (std::is_integral_v<T>) {
+            return static_cast<T>(bits);
+        } else {
+            T val;
+            std::memcpy(&val, &bits, sizeof(T));
+            return val;
+        }
+    }
+
+public:
+    explicit _InitializableArray(T init_v = T()) : arr_(Size, kBits, _to_bits(init_v)) {}
+
+    T get(size_t i) const {
+        return _from_bits(arr_.get(i));
+    }
+
+    void set(size_t i, T val) {
+        arr_.set(i, _to_bits(val));
+    }
+
+    void init(T init_v = T()) {
+        arr_.init(_to_bits(init_v));
+    }
+
+    void fill(T init_v = T()) {
+        init(init_v);
+    }
+
+    size_t size() const {return Size;}
+
+    class reference {
+    private:
+        _InitializableArray &arr_;
+        size_t i_;
+        friend class _InitializableArray;
+        reference(_InitializableArray &arr, size_t i) : arr_(arr), i_(i) {}
+    public:
+        operator T() const { return arr_.get(i_); }
+        reference& operator=(T val) {
+            arr_.set(i_, val);
+            return *this;
+        }
+    };
+
+    T operator[](size_t i) const { return get(i); }
+
+    reference operator[](size_t i) { return reference(*this, i); }
+
+};
 
 }
 
@@ -0,0 +1,164 @@
+//
+//  MappedFile.hpp
+//
+//  Read-only memory mapping of files, and arrays either owned or referring to mapped memory,
+//  so that structures written by write_vec can be loaded without copy.
+//
+
+#ifndef MappedFile_hpp
+#define MappedFile_hpp
+
+#include "basic.hpp"
+
+#include <stdexcept>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace sim_ds {
+
+/* Whole file mapped read-only.
+ * Mapping begins at page boundary, so that arrays at 8-byte aligned offsets in file are
+ * aligned in memory as well.
+ */
+class MappedFile {
+private:
+    const char* data_ = nullptr;
+    size_t size_ = 0;
+
+public:
+    MappedFile() = default;
+
+    explicit MappedFile(const std::string& path) {
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd == -1)
+            throw std::runtime_error("Failed to open " + path);
+        struct stat st;
+        if (::fstat(fd, &st) == -1) {
+            ::close(fd);
+            throw std::runtime_error("Failed to stat " + path);
+        }
+        size_ = st.st_size;
+        if (size_ > 0) {
+            void* addr = ::mmap(nullptr, size_, PROT_READ, MAP_SHARED, fd, 0);
+            if (addr == MAP_FAILED) {
+                ::close(fd);
+                throw std::runtime_error("Failed to map " + path);
+            }
+            data_ = static_cast<const char*>(addr);
+        }
+        ::close(fd);
+    }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    MappedFile(MappedFile&& x) noexcept : data_(x.data_), size_(x.size_) {
+        x.data_ = nullptr;
+        x.size_ = 0;
+    }
+
+    MappedFile& operator=(MappedFile&& x) noexcept {
+        std::swap(data_, x.data_);
+        std::swap(size_, x.size_);
+        return *this;
+    }
+
+    ~MappedFile() {
+        if (data_ != nullptr)
+            ::munmap(const_cast<char*>(data_), size_);
+    }
+
+    const char* data() const {return data_;}
+
+    size_t size() const {return size_;}
+
+};
+
+
+/* Array either owning its elements or referring to elements in mapped memory.
+ * The serialized form is the same as write_vec, that is the size followed by elements.
+ * Mapped arrays are immutable, and their memory must outlive them.
+ */
+template <typename T>
+class MappedArray {
+    static_assert(std::is_trivially_copyable_v<T>);
+public:
+    using value_type = T;
+
+private:
+    std::vector<T> owned_;
+    const T* data_ = nullptr;
+    size_t size_ = 0;
+
+public:
+    MappedArray() = default;
+
+    MappedArray(std::vector<T>&& vec) : owned_(std::move(vec)), data_(owned_.data()), size_(owned_.size()) {}
+
+    MappedArray(const MappedArray& x) : owned_(x.owned_), data_(x.is_mapped() ? x.data_ : owned_.data()), size_(x.size_) {}
+
+    MappedArray(MappedArray&& x) noexcept : owned_(std::move(x.owned_)), data_(x.data_), size_(x.size_) {
+        x.data_ = nullptr;
+        x.size_ = 0;
+    }
+
+    MappedArray& operator=(const MappedArray& x) {
+        MappedArray copy(x);
+        return *this = std::move(copy);
+    }
+
+    MappedArray& operator=(MappedArray&& x) noexcept {
+        owned_ = std::move(x.owned_);
+        data_ = x.data_;
+        size_ = x.size_;
+        x.data_ = nullptr;
+        x.size_ = 0;
+        return *this;
+    }
+
+    // Refer to the array written at pos, and advance pos to the end of it.
+    static MappedArray Map(const char*& pos) {
+        MappedArray array;
+        std::memcpy(&array.size_, pos, sizeof(size_t));
+        pos += sizeof(size_t);
+        assert(reinterpret_cast<uintptr_t>(pos) % alignof(T) == 0);
+        array.data_ = reinterpret_cast<const T*>(pos);
+        pos += sizeof(T) * array.size_;
+        return array;
+    }
+
+    const T& operator[](size_t index) const {
+        assert(index < size_);
+        return data_[index];
+    }
+
+    const T* data() const {return data_;}
+
+    size_t size() const {return size_;}
+
+    bool empty() const {return size_ == 0;}
+
+    bool is_mapped() const {return data_ != nullptr and data_ != owned_.data();}
+
+    size_t size_in_bytes() const {
+        return sizeof(T) * size_ + sizeof(size_);
+    }
+
+    void Read(std::istream& is) {
+        read_vec(is, owned_);
+        data_ = owned_.data();
+        size_ = owned_.size();
+    }
+
+    void Write(std::ostream& os) const {
+        write_val(size_, os);
+        os.write(reinterpret_cast<const char*>(data_), sizeof(T) * size_);
+    }
+
+};
+
+}
+
+#endif /* MappedFile_hpp */
@@ -15,26 +15,52 @@
 
 namespace sim_ds {
     
-template <unsigned int UnitSize>
+/* Sequence of UnitSize-bit symbols with rank dictionary of each symbol but 0.
+ *
+ * Symbols are packed in 64-bit words without straddling words.
+ * Each rank tip covers 4 * UnitSize words with L1 counts and L2 counts relative to L1.
+ * For 4- and 8-bit symbols, L2 counts are taken per 256-bit lane of 4 words,
+ * and symbols in a lane are counted by AVX2 compare and popcount.
+ *
+ * select is answered by binary search of L1 counts. If UseSelect, the search range is narrowed
+ * by sampled tips of every kSelectSampleRate-th occurrence of each symbol,
+ * which takes at most 4 bytes per rank tip of the symbol.
+ */
+template <unsigned int UnitSize, bool UseSelect = false>
 class MultiBitVector {
-    static_assert(UnitSize <= 3, "MultipleBitVector::UnitSize is overflow");
+    static_assert(UnitSize >= 1 and UnitSize <= 8, "MultipleBitVector::UnitSize is overflow");
 public:
     static constexpr size_t kBitsUnitSize = UnitSize;
-    static constexpr uint8_t kMaxNumTypes = 1ULL << kBitsUnitSize;
+    static constexpr size_t kMaxNumTypes = 1ULL << kBitsUnitSize;
     static constexpr id_type kBitsMask = kMaxNumTypes - 1;
     static constexpr size_t kBlockSize = 0x100 * kBitsUnitSize;
     static constexpr size_t kBitsInType = 0x40 - (0x40 % kBitsUnitSize);
     static constexpr size_t kBlockCapacity = kBitsInType * 4;
     static constexpr uint8_t kBitSize = 0x40;
     static constexpr uint8_t kBlocksInTipSize = kBlockSize / kBitSize;
+    static constexpr size_t kUnitsInWord = kBitsInType / kBitsUnitSize;
+    static constexpr bool kLaneRank = kBitsUnitSize == 4 or kBitsUnitSize == 8;
+    static constexpr size_t kWordsInLane = kLaneRank ? 4 : 1;
+    static constexpr size_t kUnitsInLane = kUnitsInWord * kWordsInLane;
+    static constexpr size_t kLanesInTipSize = kBlocksInTipSize / kWordsInLane;
+    static constexpr size_t kSelectSampleRate = kBlockCapacity;
     
 private:
     std::vector<id_type> bits_;
     struct RankTip {
         id_type L1;
-        uint8_t L2[kBlocksInTipSize];
+        uint8_t L2[kLanesInTipSize];
     };
     std::vector<RankTip> rank_tips_[kMaxNumTypes];
+    // Available if only UseSelect
+    std::vector<uint32_t> select_tips_[kMaxNumTypes];
+    
+    static constexpr id_type kLowBits = [] {
+        id_type m = 0;
+        for (size_t i = 0; i < kBitsInType; i += kBitsUnitSize)
+            m |= id_type(1) << i;
+        return m;
+    }();
     
     constexpr size_t block_(size_t index) const {
         return index / kBlockCapacity;
@@ -48,86 +74,53 @@ private:
         return index * kBitsUnitSize % kBitsInType;
     }
     
-    constexpr uint8_t popcnt_(uint8_t bits, id_type word) const {
-        if constexpr (kBitsUnitSize == 1) {
-            if (bits == 0)
-                return bit_util::popcnt(~word);
-            else
-                return bit_util::popcnt(word);
-        } else if (kBitsUnitSize == 2) {
-            if (bits == 0b00)
-                return bit_util::popcnt11(~word);
-            if (bits == 0b01)
-                return bit_util::popcnt10(~word);
-            if (bits == 0b10)
-                return bit_util::popcnt10(word);
-            else // bits == 0b11
-                return bit_util::popcnt11(word);
-        } else if (kBitsUnitSize == 3) {
-            if (bits & 4)
-                if (bits & 2)
-                    if (bits & 1)
-                        return bit_util::popcnt111(word);
-                    else
-                        return bit_util::popcnt110(word);
-                else
-                    if (bits & 1)
-                        return bit_util::popcnt101(word);
-                    else
-                        return bit_util::popcnt100(word);
-            else
-                if (bits & 2)
-                    if (bits & 1) // bits = 0b011
-                        return bit_util::popcnt100(~word);
-                    else          // bits = 0b010
-                        return bit_util::popcnt101(~word);
-                else
-                    if (bits & 1) // bits = 0b001
-                        return bit_util::popcnt110(~word);
-                    else          // bits = 0b000
-                        return bit_util::popcnt111(~word);
+    // Lowest bit of each unit is set iff the unit is zero.
+    static constexpr id_type zero_units_(id_type x) {
+        id_type y = x;
+        if constexpr ((kBitsUnitSize & (kBitsUnitSize - 1)) == 0) {
+            for (size_t s = 1; s < kBitsUnitSize; s *= 2)
+                y |= y >> s;
+        } else {
+            for (size_t s = 1; s < kBitsUnitSize; s++)
+                y |= x >> s;
         }
+        return ~y & kLowBits;
+    }
+    
+    static uint8_t popcnt_(uint8_t bits, id_type word) {
+        return bit_util::popcnt(zero_units_(word ^ (kLowBits * bits)));
+    }
+    
+    static uint8_t popcnt_(uint8_t bits, id_type word, size_t width) {
+        return bit_util::popcnt(zero_units_(word ^ (kLowBits * bits)) & bit_util::WidthMask(width));
     }
     
-    constexpr uint8_t popcnt_(uint8_t bits, id_type word, size_t width) const {
-        if constexpr (kBitsUnitSize == 1) {
-            if (bits == 0)
-                return bit_util::popcnt(~word & bit_util::WidthMask(width));
-            else
-                return bit_util::popcnt(word & bit_util::WidthMask(width));
-        } else if (kBitsUnitSize == 2) {
-            if (bits == 0b00)
-                return bit_util::popcnt11(~word & bit_util::WidthMask(width));
-            if (bits == 0b01)
-                return bit_util::popcnt10(~word & bit_util::WidthMask(width));
-            if (bits == 0b10)
-                return bit_util::popcnt10(word & bit_util::WidthMask(width));
-            else // bits == 0b11
-                return bit_util::popcnt11(word & bit_util::WidthMask(width));
-        } else if (kBitsUnitSize == 3) {
-            if (bits & 4)
-                if (bits & 2)
-                    if (bits & 1)
-                        return bit_util::popcnt111(word & bit_util::WidthMask(width));
-                    else
-                        return bit_util::popcnt110(word & bit_util::WidthMask(width));
-                else
-                    if (bits & 1)
-                        return bit_util::popcnt101(word & bit_util::WidthMask(width));
-                    else
-                        return bit_util::popcnt100(word & bit_util::WidthMask(width));
-            else
-                if (bits & 2)
-                    if (bits & 1) // bits = 0b011
-                        return bit_util::popcnt100(~word & bit_util::WidthMask(width));
-                    else          // bits = 0b010
-                        return bit_util::popcnt101(~word & bit_util::WidthMask(width));
-                else
-                    if (bits & 1) // bits = 0b001
-                        return bit_util::popcnt110(~word & bit_util::WidthMask(width));
-                    else          // bits = 0b000
-                        return bit_util::popcnt111(~word & bit_util::WidthMask(width));
+    // Count of symbol bits in the first num units of lane beginning at word lane_begin.
+    unsigned lane_popcnt_(uint8_t bits, size_t lane_begin, size_t num) const {
+#ifdef __AVX2__
+        if constexpr (kLaneRank) {
+            auto lane = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(bits_.data() + lane_begin));
+            auto target = _mm256_set1_epi8(bits);
+            if constexpr (kBitsUnitSize == 8) {
+                uint32_t eq = _mm256_movemask_epi8(_mm256_cmpeq_epi8(lane, target));
+                return bit_util::popcnt(eq & bit_util::WidthMask(num));
+            } else {
+                // Even units are low nibbles and odd units are high nibbles of bytes.
+                auto nibble = _mm256_set1_epi8(0x0F);
+                uint32_t eq_lo = _mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_and_si256(lane, nibble), target));
+                uint32_t eq_hi = _mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_and_si256(_mm256_srli_epi16(lane, 4), nibble), target));
+                return bit_util::popcnt(eq_lo & bit_util::WidthMask((num + 1) / 2)) +
+                       bit_util::popcnt(eq_hi & bit_util::WidthMask(num / 2));
+            }
         }
+#endif
+        unsigned cnt = 0;
+        auto w = lane_begin;
+        for (; num >= kUnitsInWord; num -= kUnitsInWord)
+            cnt += popcnt_(bits, bits_[w++]);
+        if (num > 0)
+            cnt += popcnt_(bits, bits_[w], num * kBitsUnitSize);
+        return cnt;
     }
     
 public:
@@ -137,7 +130,14 @@ public:
         return bits_[abs_(index)] >> rel_(index) & kBitsMask;
     }
     
-    constexpr unsigned long long rank(size_t index) const;
+    // Number of the same symbols as [index] in [0, index). [index] must not be 0.
+    unsigned long long rank(size_t index) const;
+    
+    // Number of symbol c in [0, index).
+    unsigned long long rank(uint8_t c, size_t index) const;
+    
+    // Position of the index-th (0 index) symbol c. c must not be 0.
+    size_t select(uint8_t c, size_t index) const;
     
     // MARK: Setter
     
@@ -166,6 +166,9 @@ public:
         auto size = size_vec(bits_);
         for (auto &tips : rank_tips_)
             size += size_vec(tips);
+        if constexpr (UseSelect)
+            for (auto &tips : select_tips_)
+                size += size_vec(tips);
         return size;
     }
     
@@ -173,55 +176,132 @@ public:
         read_vec(is, bits_);
         for (auto &tips : rank_tips_)
             read_vec(is, tips);
+        if constexpr (UseSelect)
+            for (auto &tips : select_tips_)
+                read_vec(is, tips);
     }
     
     void Write(std::ostream &os) const {
         write_vec(bits_, os);
         for (auto &tips : rank_tips_)
             write_vec(tips, os);
+        if constexpr (UseSelect)
+            for (auto &tips : select_tips_)
+                write_vec(tips, os);
     }
     
 };
 
-template <unsigned int S>
-inline constexpr unsigned long long MultiBitVector<S>::rank(size_t index) const {
+template <unsigned int S, bool U>
+inline unsigned long long MultiBitVector<S, U>::rank(size_t index) const {
     auto type = (*this)[index];
     assert(type > 0);
-    const auto& tip = rank_tips_[type - 1][block_(index)];
-    auto abs = abs_(index);
-    auto rel = rel_(index);
-    if (rel == 0) {
-        return tip.L1 + tip.L2[abs % kBlocksInTipSize];
-    } else {
-        return tip.L1 + tip.L2[abs % kBlocksInTipSize] + popcnt_(type, bits_[abs] & bit_util::WidthMask(rel));
+    return rank(type, index);
+}
+
+template <unsigned int S, bool U>
+inline unsigned long long MultiBitVector<S, U>::rank(uint8_t c, size_t index) const {
+    assert(c <= kBitsMask);
+    if (c == 0) {
+        // Symbol 0 has no dictionary as the complement of the others.
+        unsigned long long others = 0;
+        for (size_t type = 1; type < kMaxNumTypes; type++)
+            if (!rank_tips_[type - 1].empty())
+                others += rank(type, index);
+        return index - others;
     }
+    const auto& tips = rank_tips_[c - 1];
+    if (tips.empty())
+        return 0;
+    const auto& tip = tips[block_(index)];
+    auto lane = index / kUnitsInLane;
+    auto rel = index % kUnitsInLane;
+    auto cnt = tip.L1 + tip.L2[lane % kLanesInTipSize];
+    if (rel == 0)
+        return cnt;
+    if constexpr (kLaneRank)
+        return cnt + lane_popcnt_(c, lane * kWordsInLane, rel);
+    else
+        return cnt + popcnt_(c, bits_[lane], rel * kBitsUnitSize);
 }
 
-template <unsigned int S>
-inline void MultiBitVector<S>::build() {
+template <unsigned int S, bool U>
+inline size_t MultiBitVector<S, U>::select(uint8_t c, size_t index) const {
+    assert(c > 0 and c <= kBitsMask);
+    const auto& tips = rank_tips_[c - 1];
+    assert(!tips.empty());
+    size_t left = 0, right = tips.size();
+    if constexpr (U) {
+        const auto& samples = select_tips_[c - 1];
+        left = samples[index / kSelectSampleRate];
+        right = samples[index / kSelectSampleRate + 1] + 1;
+    }
+    while (left + 1 < right) {
+        const auto center = (left + right) / 2;
+        if (index < tips[center].L1) {
+            right = center;
+        } else {
+            left = center;
+        }
+    }
+    const auto& tip = tips[left];
+    auto i = index - tip.L1;
+    size_t lane = 0;
+    while (lane + 1 < kLanesInTipSize and tip.L2[lane + 1] <= i)
+        lane++;
+    i -= tip.L2[lane];
+    auto w = (left * kLanesInTipSize + lane) * kWordsInLane;
+    while (true) {
+        auto zeros = zero_units_(bits_[w] ^ (kLowBits * c));
+        auto cnt = bit_util::popcnt(zeros);
+        if (i < cnt)
+            return w * kUnitsInWord + (bit_util::sel(zeros, i + 1) - 1) / kBitsUnitSize;
+        i -= cnt;
+        w++;
+    }
+}
+
+template <unsigned int S, bool U>
+inline void MultiBitVector<S, U>::build() {
     if (bits_.size() == 0) return;
     
-    auto num_types = 0;
-    for (size_t i = 0, size = bits_.size() * kBitsInType / kBitsUnitSize; i < size; i++)
-        num_types = std::max(num_types, (*this)[i] + 1);
+    // Pad to whole tips with at least one more unit, so that rank at the end and lane loads stay in tips.
+    bits_.resize((bits_.size() / kBlocksInTipSize + 1) * kBlocksInTipSize);
+    
+    size_t num_types = 0;
+    for (size_t i = 0, size = bits_.size() * kUnitsInWord; i < size; i++)
+        num_types = std::max(num_types, size_t((*this)[i]) + 1);
     
-    const auto tips_size = std::ceil(double(bits_.size()) / kBlocksInTipSize);
+    const auto tips_size = bits_.size() / kBlocksInTipSize;
     // If bits == 0b00, don't make rank dict!
-    for (auto type = 1; type < num_types; type++) {
-        auto b = type - 1;
-        auto &tips = rank_tips_[b];
+    for (size_t type = 1; type < kMaxNumTypes; type++) {
+        auto &tips = rank_tips_[type - 1];
+        if (type >= num_types) {
+            tips.clear();
+            select_tips_[type - 1].clear();
+            continue;
+        }
         tips.resize(tips_size);
         size_t count = 0;
-        for (auto i = 0; i < tips.size(); i++) {
+        for (size_t i = 0; i < tips.size(); i++) {
             auto &tip = tips[i];
             tip.L1 = count;
-            for (auto offset = 0; offset < kBlocksInTipSize; offset++) {
+            for (size_t offset = 0; offset < kLanesInTipSize; offset++) {
                 tip.L2[offset] = count - tip.L1;
-                auto index = i * kBlocksInTipSize + offset;
-                if (index < bits_.size()) {
-                    count += popcnt_(type, bits_[index]);
-                }
+                count += lane_popcnt_(type, (i * kLanesInTipSize + offset) * kWordsInLane, kUnitsInLane);
+            }
+        }
+        if constexpr (U) {
+            // Tip containing every kSelectSampleRate-th occurrence, and the last tip.
+            auto &samples = select_tips_[type - 1];
+            samples.clear();
+            size_t threshold = 0;
+            for (size_t i = 0; i < tips.size(); i++) {
+                auto next = i + 1 < tips.size() ? tips[i + 1].L1 : count;
+                for (; threshold < next; threshold += kSelectSampleRate)
+                    samples.push_back(i);
             }
+            samples.push_back(tips.size() - 1);
         }
     }
 }
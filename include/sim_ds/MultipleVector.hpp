@@ -13,6 +13,61 @@
 
 namespace sim_ds {
 
+/* Little-endian field of Width bytes, read and written by word accesses instead of byte loops.
+ * Fixed widths compile into one or two loads/stores.
+ * Copying the low bytes of a word keeps the layout little-endian only on little-endian hosts.
+ */
+#if !defined(__BYTE_ORDER__) || __BYTE_ORDER__ != __ORDER_LITTLE_ENDIAN__
+#error "MultipleVector accesses fields by memcpy of low bytes, which requires a little-endian host."
+#endif
+
+template <size_t Width>
+inline id_type _load_bytes(const uint8_t* pointer) {
+    static_assert(Width <= sizeof(id_type));
+    id_type value = 0;
+    std::memcpy(&value, pointer, Width);
+    return value;
+}
+
+template <size_t Width>
+inline void _store_bytes(uint8_t* pointer, id_type value) {
+    static_assert(Width <= sizeof(id_type));
+    std::memcpy(pointer, &value, Width);
+}
+
+// Call fn with width as std::integral_constant, to use accessors specialized for the width.
+template <class Fn>
+inline decltype(auto) _visit_width(size_t width, Fn fn) {
+    assert(width >= 1 and width <= sizeof(id_type));
+    switch (width) {
+        case 1: return fn(std::integral_constant<size_t, 1>());
+        case 2: return fn(std::integral_constant<size_t, 2>());
+        case 3: return fn(std::integral_constant<size_t, 3>());
+        case 4: return fn(std::integral_constant<size_t, 4>());
+        case 5: return fn(std::integral_constant<size_t, 5>());
+        case 6: return fn(std::integral_constant<size_t, 6>());
+        case 7: return fn(std::integral_constant<size_t, 7>());
+        case 8: return fn(std::integral_constant<size_t, 8>());
+        default: throw std::out_of_range("MultipleVector: width of field must be in [1, 8] bytes.");
+    }
+}
+
+inline id_type _load_bytes(const uint8_t* pointer, size_t width) {
+    return _visit_width(width, [&](auto w) {return _load_bytes<decltype(w)::value>(pointer);});
+}
+
+inline void _store_bytes(uint8_t* pointer, size_t width, id_type value) {
+    _visit_width(width, [&](auto w) {_store_bytes<decltype(w)::value>(pointer, value);});
+}
+
+// Copy Width-byte fields placed at every stride bytes.
+template <size_t Width, class OutputIterator>
+inline OutputIterator _copy_fields(const uint8_t* pointer, size_t stride, size_t count, OutputIterator out) {
+    for (size_t i = 0; i < count; i++, pointer += stride)
+        *out++ = _load_bytes<Width>(pointer);
+    return out;
+}
+
 
 template <class SerializedSequence>
 class BlockReference {
@@ -77,22 +132,11 @@ private:
         assert(Id < element_table_.size());
         assert(width <= element_table_[Id].size);
         
-        id_type value = 0;
-        auto relative_pointer = pointer_ + element_table_[Id].pos;
-        for (size_t i = 0; i < width; i++)
-            value |= static_cast<id_type>(*(relative_pointer + i)) << (i * kBitsPerWord);
-        
-        return value;
+        return _load_bytes(pointer_ + element_table_[Id].pos, width);
     }
     
     id_type _get_at(size_t id) const {
-        id_type value = 0;
-        auto relative_pointer = pointer_ + element_table_[id].pos;
-        auto width = element_table_[id].size;
-        for (size_t i = 0; i < width; i++)
-            value |= static_cast<id_type>(*(relative_pointer + i)) << (i * kBitsPerWord);
-        
-        return value;
+        return _load_bytes(pointer_ + element_table_[id].pos, element_table_[id].size);
     }
     
     template <int Id, typename T>
@@ -100,20 +144,13 @@ private:
         assert(Id < element_table_.size());
         assert(width <= element_table_[Id].size);
         
-        auto relative_pointer = pointer_ + element_table_[Id].pos;
-        for (size_t i = 0; i < width; i++)
-            *(relative_pointer + i) = static_cast<storage_type>(value >> (i * kBitsPerWord));
-        
+        _store_bytes(pointer_ + element_table_[Id].pos, width, value);
         return value;
     }
     
     template <typename T>
     T _set_at(size_t id, T value) {
-        auto relative_pointer = pointer_ + element_table_[id].pos;
-        auto width = element_table_[id].size;
-        for (size_t i = 0; i < width; i++)
-            *(relative_pointer + i) = static_cast<storage_type>(value >> (i * kBitsPerWord));
-        
+        _store_bytes(pointer_ + element_table_[id].pos, element_table_[id].size, value);
         return value;
     }
     
@@ -156,12 +193,7 @@ private:
         assert(Id < element_table_.size());
         assert(width <= element_table_[Id].size);
         
-        id_type value = 0;
-        auto relative_pointer = pointer_ + element_table_[Id].pos;
-        for (size_t i = 0; i < width; i++)
-            value |= static_cast<T>(*(relative_pointer + i)) << (i * kBitsPerWord);
-        
-        return value;
+        return _load_bytes(pointer_ + element_table_[Id].pos, width);
     }
     
 };
@@ -208,18 +240,12 @@ protected:
     }
     
     id_type set_(size_t offset, size_t width, id_type value) {
-        for (size_t i = 0; i < width; i++)
-            bytes_[offset + i] = static_cast<storage_type>(value >> (i * kBitsPerWord));
-        
+        _store_bytes(bytes_.data() + offset, width, value);
         return value;
     }
     
     id_type get_(size_t offset, size_t width) const {
-        id_type value = 0;
-        for (size_t i = 0; i < width; i++)
-            value |= static_cast<id_type>(bytes_[offset + i]) << (i * kBitsPerWord);
-        
-        return value;
+        return _load_bytes(bytes_.data() + offset, width);
     }
     
 public:
@@ -282,6 +308,17 @@ public:
         return get_(offset_(index) + element_table_[Id].pos, element_table_[Id].size);
     }
     
+    // Copy elements Id of blocks in [first, last).
+    template <int Id, class OutputIterator>
+    OutputIterator copy_elements(size_t first, size_t last, OutputIterator out) const {
+        assert(Id < element_table_.size());
+        assert(first <= last and last <= size());
+        auto pointer = bytes_.data() + offset_(first) + element_table_[Id].pos;
+        return _visit_width(element_table_[Id].size, [&](auto w) {
+            return _copy_fields<decltype(w)::value>(pointer, block_size(), last - first, out);
+        });
+    }
+    
     void reserve(size_t size) {
         bytes_.reserve(offset_(size));
     }
@@ -346,6 +383,332 @@ public:
     }
     
 };
+
+
+/* Struct-of-arrays counterpart of MultipleVector.
+ * Each element of blocks is stored in its own column, so that a scan over one element
+ * reads contiguous bytes. Blocks are not contiguous, thus block references are not provided.
+ */
+class ColumnarMultipleVector {
+public:
+    using storage_type = uint8_t;
+    using param_type = size_t;
+    
+private:
+    std::vector<param_type> element_sizes_;
+    std::vector<std::vector<storage_type>> columns_;
+    size_t size_ = 0;
+    
+    const storage_type* pointer_(size_t id, size_t index) const {
+        return columns_[id].data() + index * element_sizes_[id];
+    }
+    
+    storage_type* pointer_(size_t id, size_t index) {
+        return columns_[id].data() + index * element_sizes_[id];
+    }
+    
+public:
+    ColumnarMultipleVector() = default;
+    
+    template <typename T>
+    ColumnarMultipleVector(std::initializer_list<T> sizes) {
+        set_element_sizes(std::vector<T>(sizes));
+    }
+    
+    template <typename T>
+    void set_element_sizes(std::vector<T> sizes) {
+        element_sizes_.assign(sizes.begin(), sizes.end());
+        columns_.assign(sizes.size(), {});
+        resize(size_);
+    }
+    
+    size_t block_size() const {
+        return std::accumulate(element_sizes_.begin(), element_sizes_.end(), size_t(0));
+    }
+    
+    size_t element_size(size_t id) const {
+        return element_sizes_[id];
+    }
+    
+    size_t size() const {
+        return size_;
+    }
+    
+    const storage_type* column_data(size_t id) const {
+        return columns_[id].data();
+    }
+    
+    template <int Id>
+    id_type set_nested_element(size_t index, id_type value) {
+        assert(Id < element_sizes_.size());
+        assert(index < size());
+        assert(element_sizes_[Id] == 8 || // 8 Byte element has no problem.
+               sim_ds::calc::SizeFitsInBytes(value) <= element_sizes_[Id]);
+        _store_bytes(pointer_(Id, index), element_sizes_[Id], value);
+        return value;
+    }
+    
+    template <int Id>
+    id_type nested_element(size_t index) const {
+        assert(Id < element_sizes_.size());
+        assert(index < size());
+        return _load_bytes(pointer_(Id, index), element_sizes_[Id]);
+    }
+    
+    id_type set_element_at(size_t id, size_t index, id_type value) {
+        _store_bytes(pointer_(id, index), element_sizes_[id], value);
+        return value;
+    }
+    
+    id_type element_at(size_t id, size_t index) const {
+        return _load_bytes(pointer_(id, index), element_sizes_[id]);
+    }
+    
+    // Copy elements Id of blocks in [first, last).
+    template <int Id, class OutputIterator>
+    OutputIterator copy_elements(size_t first, size_t last, OutputIterator out) const {
+        assert(Id < element_sizes_.size());
+        assert(first <= last and last <= size());
+        return _visit_width(element_sizes_[Id], [&](auto w) {
+            return _copy_fields<decltype(w)::value>(pointer_(Id, first), w, last - first, out);
+        });
+    }
+    
+    void reserve(size_t size) {
+        for (size_t id = 0; id < columns_.size(); id++)
+            columns_[id].reserve(size * element_sizes_[id]);
+    }
+    
+    void resize(size_t size) {
+        for (size_t id = 0; id < columns_.size(); id++)
+            columns_[id].resize(size * element_sizes_[id]);
+        size_ = size;
+    }
+    
+    void resize(size_t new_size, std::initializer_list<id_type> values) {
+        auto prev_size = size();
+        resize(new_size);
+        for (size_t i = prev_size; i < new_size; i++) {
+            size_t id = 0;
+            for (auto v : values)
+                set_element_at(id++, i, v);
+        }
+    }
+    
+    void emplace_back() {
+        resize(size() + 1);
+    }
+    
+    void push_back(std::initializer_list<id_type> values) {
+        resize(size() + 1, values);
+    }
+    
+    // MARK: IO
+    
+    size_t size_in_bytes() const {
+        size_t size = size_vec(element_sizes_) + sizeof(size_);
+        for (auto& column : columns_)
+            size += size_vec(column);
+        return size;
+    }
+    
+    void LoadFrom(std::istream& is) {
+        std::vector<param_type> element_sizes;
+        read_vec(is, element_sizes);
+        set_element_sizes(element_sizes);
+        size_ = read_val<size_t>(is);
+        for (auto& column : columns_)
+            read_vec(is, column);
+    }
+    
+    void StoreTo(std::ostream& os) const {
+        write_vec(element_sizes_, os);
+        write_val(size_, os);
+        for (auto& column : columns_)
+            write_vec(column, os);
+    }
+    
+};
+
+
+/* MultipleVector of which element sizes are given at compile time.
+ * Offsets, widths and the block size are constant, so that addresses of elements
+ * are folded by the compiler and bulk copies over blocks have a constant stride.
+ */
+template <size_t... Sizes>
+class StaticMultipleVector {
+    static_assert(sizeof...(Sizes) > 0);
+    static_assert(((Sizes >= 1 and Sizes <= sizeof(id_type)) and ...), "Element size must be in [1, 8]");
+public:
+    using Self = StaticMultipleVector<Sizes...>;
+    using storage_type = uint8_t;
+    using param_type = size_t;
+    
+    static constexpr size_t kNumElements = sizeof...(Sizes);
+    static constexpr std::array<size_t, kNumElements> kElementSizes = {Sizes...};
+    static constexpr std::array<size_t, kNumElements> kElementPositions = [] {
+        std::array<size_t, kNumElements> positions = {};
+        size_t pos = 0;
+        for (size_t id = 0; id < kNumElements; id++) {
+            positions[id] = pos;
+            pos += kElementSizes[id];
+        }
+        return positions;
+    }();
+    static constexpr size_t kBlockSize = (Sizes + ...);
+    
+    template <bool Const>
+    class _BlockReference {
+        using storage_pointer = std::conditional_t<Const, const storage_type*, storage_type*>;
+        storage_pointer pointer_;
+        
+        friend class StaticMultipleVector;
+        
+        explicit _BlockReference(storage_pointer pointer) noexcept : pointer_(pointer) {}
+        
+    public:
+        template <int Id>
+        id_type get() const {
+            static_assert(Id < kNumElements);
+            return _load_bytes<kElementSizes[Id]>(pointer_ + kElementPositions[Id]);
+        }
+        
+        template <int Id, typename T>
+        T restricted_get() const {
+            static_assert(Id < kNumElements);
+            return _load_bytes<std::min(kElementSizes[Id], sizeof(T))>(pointer_ + kElementPositions[Id]);
+        }
+        
+        id_type get_at(size_t id) const {
+            return _load_bytes(pointer_ + kElementPositions[id], kElementSizes[id]);
+        }
+        
+        template <int Id>
+        id_type set(id_type value) const {
+            static_assert(!Const and Id < kNumElements);
+            _store_bytes<kElementSizes[Id]>(pointer_ + kElementPositions[Id], value);
+            return value;
+        }
+        
+        template <typename T>
+        id_type set_at(size_t id, T value) const {
+            static_assert(!Const);
+            _store_bytes(pointer_ + kElementPositions[id], kElementSizes[id], value);
+            return value;
+        }
+        
+    };
+    
+    using reference = _BlockReference<false>;
+    using const_reference = _BlockReference<true>;
+    
+private:
+    std::vector<storage_type> bytes_ = {};
+    
+    static constexpr size_t offset_(size_t index) {
+        return index * kBlockSize;
+    }
+    
+public:
+    StaticMultipleVector() = default;
+    
+    static constexpr size_t block_size() {
+        return kBlockSize;
+    }
+    
+    static constexpr size_t element_size(size_t id) {
+        return kElementSizes[id];
+    }
+    
+    size_t size() const {
+        return bytes_.size() / kBlockSize;
+    }
+    
+    reference block(size_t index) {
+        return reference(bytes_.data() + offset_(index));
+    }
+    
+    const_reference block(size_t index) const {
+        return const_reference(bytes_.data() + offset_(index));
+    }
+    
+    template <int Id>
+    id_type set_nested_element(size_t index, id_type value) {
+        assert(index < size());
+        assert(kElementSizes[Id] == 8 || // 8 Byte element has no problem.
+               sim_ds::calc::SizeFitsInBytes(value) <= kElementSizes[Id]);
+        return block(index).template set<Id>(value);
+    }
+    
+    template <int Id>
+    id_type nested_element(size_t index) const {
+        assert(index < size());
+        return block(index).template get<Id>();
+    }
+    
+    // Copy elements Id of blocks in [first, last).
+    template <int Id, class OutputIterator>
+    OutputIterator copy_elements(size_t first, size_t last, OutputIterator out) const {
+        static_assert(Id < kNumElements);
+        assert(first <= last and last <= size());
+        auto pointer = bytes_.data() + offset_(first) + kElementPositions[Id];
+        return _copy_fields<kElementSizes[Id]>(pointer, kBlockSize, last - first, out);
+    }
+    
+    void reserve(size_t size) {
+        bytes_.reserve(offset_(size));
+    }
+    
+    void resize(size_t size) {
+        bytes_.resize(offset_(size));
+    }
+    
+    void resize(size_t new_size, std::initializer_list<id_type> values) {
+        auto prev_size = size();
+        resize(new_size);
+        for (size_t i = prev_size; i < new_size; i++) {
+            auto b = block(i);
+            size_t id = 0;
+            for (auto v : values)
+                b.set_at(id++, v);
+        }
+    }
+    
+    void emplace_back() {
+        bytes_.resize(offset_(size() + 1));
+    }
+    
+    void push_back(std::initializer_list<id_type> values) {
+        resize(size() + 1, values);
+    }
+    
+    // MARK: IO
+    
+    size_t size_in_bytes() const {
+        return size_vec(bytes_);
+    }
+    
+    // Compatible with MultipleVector of the same element sizes.
+    // The vector is left unchanged if element sizes mismatch.
+    void LoadFrom(std::istream& is) {
+        std::vector<storage_type> bytes;
+        read_vec(is, bytes);
+        
+        std::vector<param_type> element_sizes;
+        read_vec(is, element_sizes);
+        if (!std::equal(element_sizes.begin(), element_sizes.end(), kElementSizes.begin(), kElementSizes.end()))
+            throw std::runtime_error("StaticMultipleVector: element sizes mismatch");
+        bytes_.swap(bytes);
+    }
+    
+    void StoreTo(std::ostream& os) const {
+        write_vec(bytes_, os);
+        
+        std::vector<param_type> element_sizes(kElementSizes.begin(), kElementSizes.end());
+        write_vec(element_sizes, os);
+    }
+    
+};
     
 }
 
@@ -0,0 +1,243 @@
+//
+//  RadixHeap.hpp
+//
+//  Monotone priority queues of unsigned integer keys, interchangeable with Heap.
+//  Keys pushed must not be less than the last key popped.
+//
+
+#ifndef RadixHeap_hpp
+#define RadixHeap_hpp
+
+#include "basic.hpp"
+#include "bit_util.hpp"
+
+namespace sim_ds {
+
+/* Key of element for monotone queues.
+ * Values themselves for integers, and first of pairs such as (distance, vertex).
+ */
+template <typename T>
+struct MonotoneKey {
+    static_assert(std::is_integral_v<T>);
+    using key_type = std::make_unsigned_t<T>;
+    key_type operator()(const T& x) const {return key_type(x);}
+};
+
+template <typename K, typename V>
+struct MonotoneKey<std::pair<K, V>> {
+    static_assert(std::is_integral_v<K>);
+    using key_type = std::make_unsigned_t<K>;
+    key_type operator()(const std::pair<K, V>& x) const {return key_type(x.first);}
+};
+
+
+/* Radix heap.
+ * An element is in bucket of the highest bit differing its key from the last popped key,
+ * so the bucket index of an element only decreases.
+ * When bucket 0 is empty, the first nonempty bucket is redistributed around its minimum,
+ * and each element moves at most key width times throughout its stay.
+ *
+ * top() only locates the minimum and pop() redistributes, because keys between the last popped key
+ * and the current minimum are still allowed to be pushed until pop().
+ */
+template <typename T, class KeyOf = MonotoneKey<T>>
+class RadixHeap {
+public:
+    using value_type = T;
+    using key_type = typename KeyOf::key_type;
+    static constexpr unsigned kKeyBits = sizeof(key_type) * 8;
+
+private:
+    std::array<std::vector<T>, kKeyBits + 1> buckets_;
+    key_type last_ = 0;
+    size_t size_ = 0;
+    KeyOf key_of_;
+    // Location of the minimum found by top(), invalidated by push() and pop().
+    static constexpr size_t kNoTop = -1;
+    mutable size_t top_bucket_ = kNoTop;
+    mutable size_t top_index_ = 0;
+
+public:
+    RadixHeap() = default;
+
+    template <class Iterator>
+    RadixHeap(Iterator begin, Iterator end) {
+        for (; begin != end; ++begin)
+            push(*begin);
+    }
+
+    void push(T value) {
+        auto key = key_of_(value);
+        assert(key >= last_);
+        buckets_[_bucket(key)].push_back(std::move(value));
+        size_++;
+        top_bucket_ = kNoTop;
+    }
+
+    void pop() {
+        assert(!empty());
+        if (top_bucket_ == kNoTop)
+            _find_top();
+        auto& bucket = buckets_[top_bucket_];
+        auto key = key_of_(bucket[top_index_]);
+        std::swap(bucket[top_index_], bucket.back());
+        bucket.pop_back();
+        size_--;
+        if (top_bucket_ != 0)
+            _redistribute(top_bucket_, key);
+        top_bucket_ = kNoTop;
+    }
+
+    const T& top() const {
+        assert(!empty());
+        if (top_bucket_ == kNoTop)
+            _find_top();
+        return buckets_[top_bucket_][top_index_];
+    }
+
+    const T& front() const {
+        return top();
+    }
+
+    // The last popped key, which is the lower bound of keys to be pushed.
+    key_type last_key() const {return last_;}
+
+    size_t size() const {return size_;}
+
+    bool empty() const {return size_ == 0;}
+
+    void clear() {
+        for (auto& b : buckets_)
+            b.clear();
+        last_ = 0;
+        size_ = 0;
+        top_bucket_ = kNoTop;
+    }
+
+private:
+    size_t _bucket(key_type key) const {
+        return key == last_ ? 0 : 64 - bit_util::clz(uint64_t(key ^ last_));
+    }
+
+    // The minimum is in the first nonempty bucket, since keys of lower buckets are less.
+    void _find_top() const {
+        size_t i = 0;
+        while (buckets_[i].empty())
+            i++;
+        auto& bucket = buckets_[i];
+        top_bucket_ = i;
+        if (i == 0) {
+            top_index_ = bucket.size() - 1;
+            return;
+        }
+        auto it = std::min_element(bucket.begin(), bucket.end(), [&](auto& l, auto& r) {
+            return key_of_(l) < key_of_(r);
+        });
+        top_index_ = it - bucket.begin();
+    }
+
+    // Move up the last popped key to the minimum popped from bucket i, the first nonempty one.
+    void _redistribute(size_t i, key_type key) {
+        last_ = key;
+        auto& bucket = buckets_[i];
+        for (auto& x : bucket)
+            buckets_[_bucket(key_of_(x))].push_back(std::move(x));
+        bucket.clear();
+    }
+
+};
+
+
+/* Bucket queue (Dial's queue) for small integer keys.
+ * Buckets of keys in [cursor, cursor + num_buckets) form a ring, and the ring is doubled
+ * when a key beyond it is pushed, so memory follows the span of keys in queue.
+ * Operations are O(1) besides the cursor sweeping over empty keys.
+ */
+template <typename T, class KeyOf = MonotoneKey<T>>
+class BucketQueue {
+public:
+    using value_type = T;
+    using key_type = typename KeyOf::key_type;
+    static constexpr size_t kInitialBuckets = 64;
+
+private:
+    std::vector<std::vector<T>> buckets_;
+    key_type cursor_ = 0;
+    // No key in [cursor_, seek_) is in queue. top() advances only this hint, not cursor_.
+    mutable key_type seek_ = 0;
+    size_t size_ = 0;
+    KeyOf key_of_;
+
+public:
+    BucketQueue() : buckets_(kInitialBuckets) {}
+
+    template <class Iterator>
+    BucketQueue(Iterator begin, Iterator end) : BucketQueue() {
+        for (; begin != end; ++begin)
+            push(*begin);
+    }
+
+    void push(T value) {
+        auto key = key_of_(value);
+        assert(key >= cursor_);
+        while (key - cursor_ >= buckets_.size())
+            _expand();
+        buckets_[key & (buckets_.size() - 1)].push_back(std::move(value));
+        size_++;
+        seek_ = std::min(seek_, key);
+    }
+
+    void pop() {
+        assert(!empty());
+        _seek();
+        cursor_ = seek_;
+        buckets_[cursor_ & (buckets_.size() - 1)].pop_back();
+        size_--;
+    }
+
+    const T& top() const {
+        assert(!empty());
+        _seek();
+        return buckets_[seek_ & (buckets_.size() - 1)].back();
+    }
+
+    const T& front() const {
+        return top();
+    }
+
+    size_t size() const {return size_;}
+
+    bool empty() const {return size_ == 0;}
+
+    size_t num_buckets() const {return buckets_.size();}
+
+    void clear() {
+        for (auto& b : buckets_)
+            b.clear();
+        cursor_ = 0;
+        seek_ = 0;
+        size_ = 0;
+    }
+
+private:
+    void _seek() const {
+        while (buckets_[seek_ & (buckets_.size() - 1)].empty())
+            seek_++;
+    }
+
+    void _expand() {
+        std::vector<std::vector<T>> next(buckets_.size() * 2);
+        for (auto& b : buckets_) {
+            if (b.empty())
+                continue;
+            auto key = key_of_(b.front());
+            next[key & (next.size() - 1)] = std::move(b);
+        }
+        buckets_ = std::move(next);
+    }
+
+};
+
+}
+
+#endif /* RadixHeap_hpp */
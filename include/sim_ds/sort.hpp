@@ -11,6 +11,10 @@
 #include "basic.hpp"
 #include "Heap.hpp"
 
+#include <atomic>
+#include <random>
+#include <thread>
+
 namespace sim_ds {
 
 template <class Iterator, class Compare>
@@ -72,6 +76,226 @@ inline void HeapSort(Iterator begin, Iterator end) {
     return HeapSort(begin, end, [](auto l, auto r) {return l < r;});
 }
 
+
+// MARK: Radix sort
+
+/* Key of integer for radix sort.
+ * Sign bit of signed integers is flipped so that unsigned order of keys matches.
+ */
+struct RadixKeyIdentity {
+    template <typename T>
+    std::make_unsigned_t<T> operator()(const T& x) const {
+        static_assert(std::is_integral_v<T>);
+        using key_type = std::make_unsigned_t<T>;
+        if constexpr (std::is_signed_v<T>)
+            return key_type(x) ^ (key_type(1) << (sizeof(T)*8-1));
+        else
+            return key_type(x);
+    }
+};
+
+constexpr size_t kRadixSortThreshold = 64;
+
+/* Stable LSD radix sort by unsigned integer keys given by key_of, with 8-bit digits.
+ * Histograms of all digits are taken in one scan, and passes whose digit is common to all keys are skipped.
+ * Values are moved between the range and a buffer of the same size, so they must be default constructible.
+ */
+template <class Iterator, class KeyOf>
+inline void LsdRadixSort(Iterator begin, Iterator end, KeyOf key_of) {
+    using value_type = typename std::iterator_traits<Iterator>::value_type;
+    using key_type = std::decay_t<decltype(key_of(*begin))>;
+    static_assert(std::is_unsigned_v<key_type>);
+    constexpr unsigned kNumPasses = sizeof(key_type);
+    const size_t n = end - begin;
+    if (n < kRadixSortThreshold) {
+        std::stable_sort(begin, end, [&](auto& l, auto& r) {return key_of(l) < key_of(r);});
+        return;
+    }
+    std::vector<std::array<size_t, 256>> counts(kNumPasses);
+    for (auto& c : counts)
+        c.fill(0);
+    for (auto it = begin; it != end; ++it) {
+        auto key = key_of(*it);
+        for (unsigned p = 0; p < kNumPasses; p++)
+            counts[p][(key >> (p*8)) & 0xFF]++;
+    }
+    std::vector<value_type> buffer(n);
+    bool in_buffer = false;
+    auto key_of_first = key_of(*begin);
+    for (unsigned p = 0; p < kNumPasses; p++) {
+        auto& count = counts[p];
+        if (count[(key_of_first >> (p*8)) & 0xFF] == n)
+            continue;
+        size_t sum = 0;
+        for (auto& c : count) {
+            auto t = c;
+            c = sum;
+            sum += t;
+        }
+        if (!in_buffer) {
+            for (auto it = begin; it != end; ++it)
+                buffer[count[(key_of(*it) >> (p*8)) & 0xFF]++] = std::move(*it);
+        } else {
+            for (auto& v : buffer)
+                begin[count[(key_of(v) >> (p*8)) & 0xFF]++] = std::move(v);
+        }
+        in_buffer = !in_buffer;
+    }
+    if (in_buffer)
+        std::move(buffer.begin(), buffer.end(), begin);
+}
+
+template <class Iterator, class KeyOf>
+inline void _MsdRadixSort(Iterator begin, Iterator end, KeyOf key_of, int shift) {
+    const size_t n = end - begin;
+    if (n < kRadixSortThreshold) {
+        std::sort(begin, end, [&](auto& l, auto& r) {return key_of(l) < key_of(r);});
+        return;
+    }
+    auto digit = [&](auto& v) {return (key_of(v) >> shift) & 0xFF;};
+    std::array<size_t, 257> bounds = {};
+    for (auto it = begin; it != end; ++it)
+        bounds[digit(*it) + 1]++;
+    if (bounds[digit(*begin) + 1] < n) {
+        for (size_t d = 0; d < 256; d++)
+            bounds[d+1] += bounds[d];
+        // American flag sort: move each value to the head of its bucket in cycles.
+        std::array<size_t, 256> heads;
+        std::copy(bounds.begin(), bounds.end() - 1, heads.begin());
+        for (size_t d = 0; d < 256; d++) {
+            while (heads[d] < bounds[d+1]) {
+                auto v = std::move(begin[heads[d]]);
+                size_t dv;
+                while ((dv = digit(v)) != d)
+                    std::swap(v, begin[heads[dv]++]);
+                begin[heads[d]++] = std::move(v);
+            }
+        }
+        if (shift == 0)
+            return;
+        for (size_t d = 0; d < 256; d++)
+            if (bounds[d+1] - bounds[d] > 1)
+                _MsdRadixSort(begin + bounds[d], begin + bounds[d+1], key_of, shift - 8);
+    } else if (shift > 0) {
+        _MsdRadixSort(begin, end, key_of, shift - 8);
+    }
+}
+
+/* In-place MSD radix sort by unsigned integer keys given by key_of, with 8-bit digits.
+ * It needs no buffer but is not stable.
+ */
+template <class Iterator, class KeyOf>
+inline void MsdRadixSort(Iterator begin, Iterator end, KeyOf key_of) {
+    using key_type = std::decay_t<decltype(key_of(*begin))>;
+    static_assert(std::is_unsigned_v<key_type>);
+    if (begin == end)
+        return;
+    _MsdRadixSort(begin, end, key_of, int(sizeof(key_type)-1) * 8);
+}
+
+template <class Iterator>
+inline void MsdRadixSort(Iterator begin, Iterator end) {
+    MsdRadixSort(begin, end, RadixKeyIdentity());
+}
+
+template <class Iterator, class KeyOf>
+inline void RadixSort(Iterator begin, Iterator end, KeyOf key_of) {
+    LsdRadixSort(begin, end, key_of);
+}
+
+template <class Iterator>
+inline void RadixSort(Iterator begin, Iterator end) {
+    LsdRadixSort(begin, end, RadixKeyIdentity());
+}
+
+
+// MARK: Sample sort
+
+constexpr size_t kSampleSortThreshold = 1u<<16;
+
+// Run fn(t) for t in [0, num_threads) on num_threads threads including the caller.
+template <class Fn>
+inline void _RunThreads(unsigned num_threads, Fn fn) {
+    std::vector<std::thread> threads;
+    for (unsigned t = 1; t < num_threads; t++)
+        threads.emplace_back(fn, t);
+    fn(0);
+    for (auto& th : threads)
+        th.join();
+}
+
+/* Parallel sample sort by general comparator. It is not stable.
+ * Splitters are taken from oversampled values, then each thread classifies a chunk into
+ * buckets and scatters it to a buffer, and the buckets are sorted by std::sort in parallel.
+ * Buckets outnumber threads to balance loads. Values must be default constructible.
+ */
+template <class Iterator, class Compare>
+inline void SampleSort(Iterator begin, Iterator end, Compare compare,
+                       unsigned num_threads = std::thread::hardware_concurrency()) {
+    using value_type = typename std::iterator_traits<Iterator>::value_type;
+    constexpr size_t kOversampling = 16;
+    const size_t n = end - begin;
+    num_threads = std::max(num_threads, 1u);
+    if (num_threads == 1 or n < kSampleSortThreshold) {
+        std::sort(begin, end, compare);
+        return;
+    }
+    const size_t num_buckets = num_threads * 4;
+    std::vector<value_type> splitters;
+    {
+        std::mt19937_64 rnd(n);
+        std::vector<value_type> samples;
+        samples.reserve(num_buckets * kOversampling);
+        for (size_t i = 0; i < num_buckets * kOversampling; i++)
+            samples.push_back(begin[rnd() % n]);
+        std::sort(samples.begin(), samples.end(), compare);
+        for (size_t b = 1; b < num_buckets; b++)
+            splitters.push_back(samples[b * kOversampling]);
+    }
+    auto chunk_begin = [&](size_t t) {return n * t / num_threads;};
+    std::vector<uint32_t> bucket_of(n);
+    std::vector<std::vector<size_t>> offsets(num_threads, std::vector<size_t>(num_buckets + 1));
+    _RunThreads(num_threads, [&](unsigned t) {
+        auto& count = offsets[t];
+        for (size_t i = chunk_begin(t); i < chunk_begin(t+1); i++) {
+            auto b = std::upper_bound(splitters.begin(), splitters.end(), begin[i], compare) - splitters.begin();
+            bucket_of[i] = b;
+            count[b]++;
+        }
+    });
+    std::vector<size_t> bucket_bounds(num_buckets + 1);
+    size_t sum = 0;
+    for (size_t b = 0; b < num_buckets; b++) {
+        bucket_bounds[b] = sum;
+        for (unsigned t = 0; t < num_threads; t++) {
+            auto c = offsets[t][b];
+            offsets[t][b] = sum;
+            sum += c;
+        }
+    }
+    bucket_bounds[num_buckets] = n;
+    std::vector<value_type> buffer(n);
+    _RunThreads(num_threads, [&](unsigned t) {
+        auto& offset = offsets[t];
+        for (size_t i = chunk_begin(t); i < chunk_begin(t+1); i++)
+            buffer[offset[bucket_of[i]]++] = std::move(begin[i]);
+    });
+    std::atomic<size_t> next_bucket{0};
+    _RunThreads(num_threads, [&](unsigned) {
+        size_t b;
+        while ((b = next_bucket.fetch_add(1)) < num_buckets) {
+            auto first = buffer.begin() + bucket_bounds[b], last = buffer.begin() + bucket_bounds[b+1];
+            std::sort(first, last, compare);
+            std::move(first, last, begin + bucket_bounds[b]);
+        }
+    });
+}
+
+template <class Iterator>
+inline void SampleSort(Iterator begin, Iterator end) {
+    SampleSort(begin, end, std::less<>());
+}
+
 }
 
 #endif /* sort_hpp */
@@ -0,0 +1,326 @@
+//
+//  AhoCorasick.hpp
+//
+//  Multi-pattern matching on Aho-Corasick automaton in double array.
+//
+
+#ifndef AhoCorasick_hpp
+#define AhoCorasick_hpp
+
+#include "sim_ds/basic.hpp"
+#include "sim_ds/BitVector.hpp"
+#include "sim_ds/bit_util.hpp"
+#include "sim_ds/string_util/graph_util.hpp"
+#include "sim_ds/string_util/PatternMatching.hpp"
+
+namespace sim_ds {
+
+/* Aho-Corasick automaton of keys.
+ * Goto function of the trie (graph_util::Trie) is placed in double array, where a child of
+ * state s by label c is at slot base(s) ^ c with check of s, so that slots of a state lie in
+ * a block of 256 as in FactorOracle. Failure links and links to the nearest terminal state
+ * on failure path (dictionary links) follow.
+ * Bases are searched over the bitmap of used slots word by word as in FactorOracle, skipping
+ * full blocks and blocks closed after kMaxBlockTrials failed searches.
+ *
+ * Keys must not contain '\0', the leaf label of the trie, and a key inserted twice is
+ * reported by its last id.
+ */
+class AhoCorasick {
+public:
+    using id_type = uint32_t;
+
+    struct Match {
+        size_t pos;
+        size_t key_id;
+
+        bool operator==(const Match& x) const {return pos == x.pos and key_id == x.key_id;}
+    };
+
+    static constexpr id_type kRoot = 0;
+    static constexpr id_type kEmptyValue = std::numeric_limits<id_type>::max();
+    static constexpr size_t kBlockSize = 0x100;
+    static constexpr size_t kWordsInBlock = kBlockSize / 64;
+    static constexpr size_t kMaxBlockTrials = 4;
+
+private:
+    struct Unit {
+        id_type base;
+        id_type check;
+    };
+
+    std::vector<Unit> units_;
+    std::vector<id_type> fail_;
+    std::vector<id_type> dict_;
+    std::vector<id_type> terminal_;
+    std::vector<size_t> key_sizes_;
+    // Classes of bytes leaving root in nibbles, for the prefilter of shufti
+    std::array<uint8_t, 16> lo_classes_ = {};
+    std::array<uint8_t, 16> hi_classes_ = {};
+
+public:
+    template <class InputIter>
+    AhoCorasick(InputIter begin, InputIter end) {
+        graph_util::Trie<size_t, size_t> trie;
+        for (; begin != end; ++begin) {
+            std::string_view key = *begin;
+            assert(not key.empty() and key.find('\0') == std::string_view::npos);
+            trie.insert(key, key_sizes_.size());
+            key_sizes_.push_back(key.size());
+        }
+        _build(trie);
+    }
+
+    AhoCorasick(const std::vector<std::string_view>& keys) : AhoCorasick(keys.begin(), keys.end()) {}
+
+    AhoCorasick(const std::vector<std::string>& keys) : AhoCorasick(keys.begin(), keys.end()) {}
+
+    // Matches in order of end positions, and longer keys first on the same end.
+    // Callback returning false stops the enumeration.
+    template <class Callback>
+    void for_each_match(std::string_view text, Callback callback) const {
+        id_type state = kRoot;
+        for (size_t i = 0; i < text.size(); i++) {
+            state = _next(state, text[i]);
+            if (not _report(state, i + 1, callback))
+                return;
+        }
+    }
+    
+    std::vector<Match> find_all(std::string_view text) const {return pattern_matching::_collect_matches<Match>(*this, text);}
+    
+    template <class OutputIter>
+    OutputIter find_all(std::string_view text, OutputIter out) const {return pattern_matching::_copy_matches(*this, text, out);}
+    
+    size_t count(std::string_view text) const {return pattern_matching::_count_matches(*this, text);}
+    
+    std::optional<Match> find_first(std::string_view text) const {return pattern_matching::_find_first_match<Match>(*this, text);}
+
+    /* Same as find_all, while bytes at root not leaving it are skipped 32 at once by AVX2.
+     * Bytes are classified by their nibbles (shufti), so that a byte set of any size is tested
+     * by two shuffles, while some bytes not leaving root may be read one by one.
+     * Effective when keys begin with a few kinds of bytes rare in text.
+     */
+    template <class Callback>
+    void for_each_match_prefiltered(std::string_view text, Callback callback) const {
+        id_type state = kRoot;
+        size_t i = 0;
+        while (i < text.size()) {
+            if (state == kRoot) {
+                i = _skip_from_root(text, i);
+                if (i == text.size())
+                    break;
+            }
+            state = _next(state, text[i]);
+            if (not _report(state, i + 1, callback))
+                return;
+            i++;
+        }
+    }
+    
+    std::vector<Match> find_all_prefiltered(std::string_view text) const {
+        std::vector<Match> matchies;
+        for_each_match_prefiltered(text, [&](const Match& m) {matchies.push_back(m);});
+        return matchies;
+    }
+
+    size_t num_keys() const {return key_sizes_.size();}
+
+    size_t num_slots() const {return units_.size();}
+
+    size_t size_in_bytes() const {
+        return size_vec(units_) + size_vec(fail_) + size_vec(dict_) + size_vec(terminal_) + size_vec(key_sizes_) + sizeof(lo_classes_) + sizeof(hi_classes_);
+    }
+
+private:
+    id_type _child(id_type state, uint8_t c) const {
+        size_t slot = units_[state].base ^ c;
+        if (slot < units_.size() and units_[slot].check == state)
+            return slot;
+        return kEmptyValue;
+    }
+
+    id_type _next(id_type state, uint8_t c) const {
+        while (true) {
+            auto child = _child(state, c);
+            if (child != kEmptyValue)
+                return child;
+            if (state == kRoot)
+                return kRoot;
+            state = fail_[state];
+        }
+    }
+
+    template <class Callback>
+    bool _report(id_type state, size_t end, Callback& callback) const {
+        if (terminal_[state] == kEmptyValue)
+            state = dict_[state];
+        for (; state != kRoot; state = dict_[state]) {
+            auto id = terminal_[state];
+            if (not pattern_matching::_emit(callback, Match{end - key_sizes_[id], id}))
+                return false;
+        }
+        return true;
+    }
+
+    bool _leaves_root(uint8_t c) const {
+        return lo_classes_[c & 0x0F] & hi_classes_[c >> 4];
+    }
+
+    size_t _skip_from_root(std::string_view text, size_t i) const {
+#ifdef __AVX2__
+        const auto lo_table = _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(lo_classes_.data())));
+        const auto hi_table = _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(hi_classes_.data())));
+        const auto nibble = _mm256_set1_epi8(0x0F);
+        for (; i + 32 <= text.size(); i += 32) {
+            auto bytes = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(text.data() + i));
+            auto lo = _mm256_shuffle_epi8(lo_table, _mm256_and_si256(bytes, nibble));
+            auto hi = _mm256_shuffle_epi8(hi_table, _mm256_and_si256(_mm256_srli_epi16(bytes, 4), nibble));
+            auto staying = _mm256_cmpeq_epi8(_mm256_and_si256(lo, hi), _mm256_setzero_si256());
+            uint32_t leaving = ~uint32_t(_mm256_movemask_epi8(staying));
+            if (leaving)
+                return i + bit_util::ctz(leaving);
+        }
+#endif
+        while (i < text.size() and not _leaves_root(text[i]))
+            i++;
+        return i;
+    }
+
+    static bool _block_is_full(const BitVector& used, size_t block) {
+        auto words = used.data() + block * kWordsInBlock;
+#ifdef __AVX2__
+        auto v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(words));
+        return _mm256_testc_si256(v, _mm256_set1_epi64x(-1));
+#else
+        return (words[0] & words[1] & words[2] & words[3]) == bit_util::kMaskFill;
+#endif
+    }
+
+    // Grow geometrically to keep the amortized cost of expansion constant.
+    void _expand_block(BitVector& used, std::vector<uint8_t>& block_trials) {
+        auto num_blocks = units_.size() / kBlockSize;
+        auto new_size = (num_blocks + std::max<size_t>(1, num_blocks / 8)) * kBlockSize;
+        units_.resize(new_size, {kEmptyValue, kEmptyValue});
+        terminal_.resize(new_size, kEmptyValue);
+        fail_.resize(new_size, kRoot);
+        used.resize(new_size);
+        block_trials.resize(new_size / kBlockSize);
+    }
+
+    // Base whose slots of all labels are free.
+    size_t _find_base(const std::vector<std::pair<uint8_t, size_t>>& children,
+                      BitVector& used,
+                      std::vector<uint8_t>& block_trials,
+                      size_t& front_block) {
+        auto closed = [&](size_t block) {
+            return block_trials[block] >= kMaxBlockTrials or _block_is_full(used, block);
+        };
+        while (front_block < block_trials.size() and closed(front_block))
+            front_block++;
+        const auto first_label = children.front().first;
+        for (auto block = front_block; ; block++) {
+            if (block == block_trials.size())
+                _expand_block(used, block_trials);
+            if (closed(block))
+                continue;
+            for (size_t w = 0; w < kWordsInBlock; w++) {
+                auto empties = ~used.data()[block * kWordsInBlock + w];
+                for (; empties; empties &= empties - 1) {
+                    auto base = ((block * kWordsInBlock + w) * 64 + bit_util::ctz(empties)) ^ first_label;
+                    bool fits = true;
+                    for (auto& child : children) {
+                        if (used[base ^ child.first]) {
+                            fits = false;
+                            break;
+                        }
+                    }
+                    if (fits)
+                        return base;
+                }
+            }
+            block_trials[block]++;
+        }
+    }
+
+    void _build(const graph_util::Trie<size_t, size_t>& trie) {
+        units_.assign(kBlockSize, {kEmptyValue, kEmptyValue});
+        BitVector used(kBlockSize);
+        used[kRoot] = true;
+        std::vector<uint8_t> block_trials(1);
+        size_t front_block = 0;
+        std::vector<id_type> states_of_trie(trie.size(), kEmptyValue);
+        states_of_trie[graph_util::kRootIndex] = kRoot;
+        terminal_.assign(kBlockSize, kEmptyValue);
+        fail_.assign(kBlockSize, kRoot);
+
+        // Place children of each node breadth-first. Failure link of a child is made on placement,
+        // since states on the failure path of its parent are shallower and already placed.
+        std::vector<size_t> queue = {graph_util::kRootIndex};
+        std::vector<id_type> order = {kRoot};
+        for (size_t qi = 0; qi < queue.size(); qi++) {
+            auto node = queue[qi];
+            auto state = states_of_trie[node];
+            std::vector<std::pair<uint8_t, size_t>> children;
+            trie.node(node).for_each_edge([&](uint8_t c, size_t target) {
+                auto& t = trie.node(target);
+                if (c == graph_util::kLeafChar) {
+                    terminal_[state] = trie.item(t.item_index());
+                } else {
+                    children.emplace_back(c, target);
+                }
+            });
+            if (children.empty())
+                continue;
+            auto base = _find_base(children, used, block_trials, front_block);
+            if (base + kBlockSize > kEmptyValue)
+                throw std::length_error("Slots of Aho-Corasick automaton exceed the range of id_type.");
+            units_[state].base = base;
+            for (auto& child : children) {
+                auto slot = base ^ child.first;
+                used[slot] = true;
+                units_[slot].check = state;
+                if (state != kRoot)
+                    fail_[slot] = _next(fail_[state], child.first);
+                states_of_trie[child.second] = slot;
+                queue.push_back(child.second);
+                order.push_back(slot);
+            }
+        }
+
+        // Trim blocks behind the last one in use.
+        size_t num_blocks = 1;
+        for (size_t i = 0; i < units_.size(); i++) {
+            if (used[i])
+                num_blocks = i / kBlockSize + 1;
+        }
+        units_.resize(num_blocks * kBlockSize);
+        units_.shrink_to_fit();
+        terminal_.resize(units_.size());
+        terminal_.shrink_to_fit();
+        fail_.resize(units_.size());
+        fail_.shrink_to_fit();
+
+        // Dictionary links in breadth-first order, after all terminals are known.
+        dict_.assign(units_.size(), kRoot);
+        for (size_t i = 1; i < order.size(); i++) {
+            auto state = order[i];
+            auto f = fail_[state];
+            dict_[state] = terminal_[f] != kEmptyValue ? f : dict_[f];
+        }
+
+        for (size_t c = 1; c < 0x100; c++) {
+            if (_child(kRoot, c) == kEmptyValue)
+                continue;
+            // Classes of high nibbles folded into 8 bits
+            uint8_t cls = 1u << ((c >> 4) % 8);
+            lo_classes_[c & 0x0F] |= cls;
+            hi_classes_[c >> 4] = cls;
+        }
+    }
+
+};
+
+}
+
+#endif /* AhoCorasick_hpp */
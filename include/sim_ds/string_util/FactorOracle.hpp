@@ -8,16 +8,28 @@
 #define FactorOracle_hpp
 
 #include "sim_ds/BitVector.hpp"
+#include "sim_ds/MappedFile.hpp"
 
 namespace sim_ds {
 
 
+/* Builder of double-array factor oracle.
+ *
+ * Transitions of a state are placed at base ^ label, so a base and its transitions lie in
+ * the same block of 256 slots. Bases are searched over the bitmap of used slots word by word,
+ * skipping full blocks (a block of 256 bits is one AVX2 register) and blocks closed after
+ * kMaxBlockTrials failed searches, so that searches do not revisit crowded blocks.
+ * While building, each slot keeps label ^ slot (the low byte of the base owning it),
+ * so that transitions of a state are found by comparing 256 bytes of its block at once.
+ */
 template <typename IdType>
 class FactorOracleBaseCTAFOBuilder {
 public:
     using id_type = IdType;
     
     static constexpr size_t kBlockSize = 0x100;
+    static constexpr size_t kWordsInBlock = kBlockSize / 64;
+    static constexpr size_t kMaxBlockTrials = 4;
     static constexpr id_type kEmptyValue = std::numeric_limits<id_type>::max();
     
 private:
@@ -25,27 +37,21 @@ private:
     std::vector<id_type> base_;
     std::vector<id_type> next_;
     
-    size_t empty_trans_front_ = 0;
     BitVector used_state_;
     BitVector used_trans_;
-    std::vector<id_type> prev_;
+    std::vector<uint8_t> owners_;
+    std::vector<uint8_t> block_trials_;
+    size_t front_block_ = 0;
     
-    friend class FactorOracleBaseCTAFO;
+    template <typename> friend class FactorOracleBaseCTAFO;
     
     void _build() {
-//        std::cerr << "_build FO" << std::endl;
         const size_t kKeySize = check_.size();
         const size_t kNumStates = kKeySize + 1;
         
-//        std::cerr << " expand block" << std::endl;
-        int cnt = 0;
-        while (next_.size() < kNumStates - 1) {
-//            std::cerr << ++cnt << std::endl;
-            _expand_block();
-        }
+        _resize((kNumStates + kBlockSize - 1) / kBlockSize * kBlockSize);
         std::vector<id_type> lrs(kNumStates);
         
-//        std::cerr << " edging" << std::endl;
         // Add letters on-line algorithm
         set_next(0, 0);
         for (size_t i = 0; i < kKeySize; i++) {
@@ -58,7 +64,14 @@ private:
             lrs[i + 1] = k == i + 1 ? 0 : transition(k, i + 1);
         }
         
-//        std::cerr << " clear" << std::endl;
+        // Trim blocks behind the last one in use.
+        size_t num_blocks = 1;
+        for (size_t i = 0; i < next_.size(); i++) {
+            if (used_trans_[i] or used_state_[i])
+                num_blocks = i / kBlockSize + 1;
+        }
+        next_.resize(num_blocks * kBlockSize);
+        next_.shrink_to_fit();
         // Initialize empty-element of next to zero.
         for (size_t i = 0; i < next_.size(); i++) {
             if (not used_trans_[i])
@@ -66,54 +79,67 @@ private:
         }
     }
     
+    size_t _num_blocks() const {
+        return next_.size() / kBlockSize;
+    }
+    
     void _resize(size_t new_size) {
-        next_.resize(new_size);
+        if (new_size > kEmptyValue)
+            throw std::length_error("Slots of factor oracle exceed the range of id_type.");
+        next_.resize(new_size, kEmptyValue);
         used_state_.resize(new_size);
         used_trans_.resize(new_size);
-        prev_.resize(new_size);
+        owners_.resize(new_size);
+        block_trials_.resize(new_size / kBlockSize);
     }
     
+    // Grow geometrically to keep the amortized cost of expansion constant.
     void _expand_block() {
-        size_t begin = next_.size();
-        _resize(next_.size() + kBlockSize);
-        size_t end = next_.size();
-        // empty-element linking
-        if (empty_trans_front_ != 0 or not used_trans_[0]) {
-            auto old_back = prev_[empty_trans_front_];
-            prev_[begin] = old_back;
-            next_[old_back] = begin;
-            prev_[empty_trans_front_] = end - 1;
-        } else {
-            prev_[begin] = end - 1;
-            empty_trans_front_ = begin;
-        }
-        next_[begin] = begin + 1;
-        for (size_t i = begin + 1; i < end - 1; i++) {
-            next_[i] = i + 1;
-            prev_[i] = i - 1;
-        }
-        next_[end - 1] = empty_trans_front_;
-        prev_[end - 1] = end - 2;
+        _resize((_num_blocks() + std::max<size_t>(1, _num_blocks() / 8)) * kBlockSize);
+    }
+    
+    bool _block_is_full(size_t block) const {
+        auto words = used_trans_.data() + block * kWordsInBlock;
+#ifdef __AVX2__
+        auto v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(words));
+        return _mm256_testc_si256(v, _mm256_set1_epi64x(-1));
+#else
+        return (words[0] & words[1] & words[2] & words[3]) == bit_util::kMaskFill;
+#endif
+    }
+    
+    bool _block_is_closed(size_t block) const {
+        return block_trials_[block] >= kMaxBlockTrials or _block_is_full(block);
     }
     
     size_t _find_base(const std::vector<id_type>& transes) {
-        for (auto index = empty_trans_front_; ; index = next(index)) {
-            assert(not used_trans_[index]);
-            auto b = index ^ check(transes.front());
-            if (not used_state_[b]) {
-                bool skip = false;
-                for (auto t : transes) {
-                    if (used_trans_[b ^ check(t)]) {
-                        skip = true;
-                        break;
+        while (front_block_ < _num_blocks() and _block_is_closed(front_block_))
+            front_block_++;
+        const auto first_label = check(transes.front());
+        for (auto block = front_block_; ; block++) {
+            if (block == _num_blocks())
+                _expand_block();
+            if (_block_is_closed(block))
+                continue;
+            for (size_t w = 0; w < kWordsInBlock; w++) {
+                auto empties = ~used_trans_.data()[block * kWordsInBlock + w];
+                for (; empties; empties &= empties - 1) {
+                    auto index = (block * kWordsInBlock + w) * 64 + bit_util::ctz(empties);
+                    auto b = index ^ first_label;
+                    if (used_state_[b])
+                        continue;
+                    bool skip = false;
+                    for (auto t : transes) {
+                        if (used_trans_[b ^ check(t)]) {
+                            skip = true;
+                            break;
+                        }
                     }
+                    if (not skip)
+                        return b;
                 }
-                if (not skip)
-                    return b;
-            }
-            if (next(index) == empty_trans_front_) {
-                _expand_block();
             }
+            block_trials_[block]++;
         }
         throw std::logic_error("Not found base due to unknown factor.");
     }
@@ -152,25 +178,44 @@ private:
     }
     
 public:
-    explicit FactorOracleBaseCTAFOBuilder(std::string_view text) : check_(text.begin(), text.end()), base_(text.size() + 1, kEmptyValue) {
-        _build();
-    }
+    explicit FactorOracleBaseCTAFOBuilder(std::string_view text) : FactorOracleBaseCTAFOBuilder(text.begin(), text.end()) {}
     
     template <class InputIter, class IterTraits = std::iterator_traits<InputIter>,
               class CharTraits = std::char_traits<typename IterTraits::value_type>>
-    explicit FactorOracleBaseCTAFOBuilder(InputIter begin, InputIter end) : check_(begin, end), base_(end - begin + 1, kEmptyValue) {
+    explicit FactorOracleBaseCTAFOBuilder(InputIter begin, InputIter end) {
+        if (size_t(end - begin) >= kEmptyValue)
+            throw std::length_error("States of factor oracle exceed the range of id_type.");
+        check_.assign(begin, end);
+        base_.assign(check_.size() + 1, kEmptyValue);
         _build();
     }
     
+    // Transitions of state, found among used slots in the block of its base.
     std::vector<id_type> get_transes(size_t state) const {
         auto b = base(state);
         if (b == kEmptyValue)
             return {};
         std::vector<id_type> transes;
-        for (size_t c = 1; c <= 0xff; c++) {
-            auto n = next(b ^ c);
-            if (used_trans_[b ^ c] and n > 0 and check(n) == c) {
-                transes.push_back(n);
+        auto block = b / kBlockSize;
+        const uint8_t owner = b;
+        auto owners = owners_.data() + block * kBlockSize;
+        for (size_t w = 0; w < kWordsInBlock; w++) {
+            uint64_t owned;
+#ifdef __AVX2__
+            auto target = _mm256_set1_epi8(owner);
+            auto lo = _mm256_cmpeq_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(owners + w * 64)), target);
+            auto hi = _mm256_cmpeq_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(owners + w * 64 + 32)), target);
+            owned = uint32_t(_mm256_movemask_epi8(lo)) | (uint64_t(uint32_t(_mm256_movemask_epi8(hi))) << 32);
+#else
+            owned = 0;
+            for (size_t i = 0; i < 64; i++)
+                owned |= uint64_t(owners[w * 64 + i] == owner) << i;
+#endif
+            owned &= used_trans_.data()[block * kWordsInBlock + w];
+            for (; owned; owned &= owned - 1) {
+                auto index = (block * kWordsInBlock + w) * 64 + bit_util::ctz(owned);
+                if (index != b and next(index) > 0)
+                    transes.push_back(next(index));
             }
         }
         return transes;
@@ -178,14 +223,8 @@ public:
     
     void set_next(size_t index, id_type x) {
         assert(not used_trans_[index]);
-        if (next(index) != kEmptyValue) {
-            if (empty_trans_front_ == index) {
-                empty_trans_front_ = next(index) == empty_trans_front_ ? 0 : next(index);
-            }
-            next_[prev_[index]] = next(index);
-            prev_[next(index)] = prev_[index];
-        }
         used_trans_[index] = true;
+        owners_[index] = check(x) ^ index;
         next_[index] = x;
     }
     
@@ -200,7 +239,7 @@ public:
         if (not used_trans_[trans])
             return 0;
         auto next_state = next(trans);
-        if (next_state == 0 or check(next_state) != check(n)) {
+        if (next_state == 0 or owners_[trans] != uint8_t(b)) {
             return 0;
         }
         return next_state;
@@ -215,22 +254,37 @@ public:
 };
 
 
+/* Double-array factor oracle of ids in IdType.
+ * Both of base and next hold ids of at most the number of slots, which is around the text
+ * length, so the narrowest IdType fitting the text keeps image() in fewer cache lines.
+ * Arrays are serialized after the id width in order of base, next and check, so that id arrays
+ * lie at aligned offsets, and Map() refers to them in place, e.g. in a MappedFile.
+ */
+template <typename IdType>
 class FactorOracleBaseCTAFO {
+    static_assert(std::is_unsigned_v<IdType>);
 public:
-    using id_type = uint32_t;
+    using id_type = IdType;
     
     using Builder = FactorOracleBaseCTAFOBuilder<id_type>;
     
     static constexpr id_type kEmptyValue = std::numeric_limits<id_type>::max();
     
 private:
-    std::vector<uint8_t> check_;
-    std::vector<id_type> base_;
-    std::vector<id_type> next_;
+    MappedArray<uint8_t> check_;
+    MappedArray<id_type> base_;
+    MappedArray<id_type> next_;
+    
+protected:
+    FactorOracleBaseCTAFO() = default;
     
 public:
     explicit FactorOracleBaseCTAFO(Builder&& builder) : check_(std::move(builder.check_)), base_(std::move(builder.base_)), next_(std::move(builder.next_)) {}
     
+    explicit FactorOracleBaseCTAFO(std::istream& is) {
+        Read(is);
+    }
+    
     template <class InputIter>
     explicit FactorOracleBaseCTAFO(InputIter begin, InputIter end) : FactorOracleBaseCTAFO(Builder(begin, end)) {
         static_assert(std::is_convertible_v<typename std::iterator_traits<InputIter>::value_type, char>);
@@ -244,6 +298,45 @@ public:
     
     id_type next(size_t index) const {return next_[index];}
     
+    size_t num_states() const {return check_.size() + 1;}
+    
+    size_t size_in_bytes() const {
+        return check_.size_in_bytes() + base_.size_in_bytes() + next_.size_in_bytes();
+    }
+    
+    void Read(std::istream& is) {
+        _check_id_width(read_val<size_t>(is));
+        base_.Read(is);
+        next_.Read(is);
+        check_.Read(is);
+    }
+    
+    void Write(std::ostream& os) const {
+        write_val(sizeof(id_type), os);
+        base_.Write(os);
+        next_.Write(os);
+        check_.Write(os);
+    }
+    
+    // Refer to arrays written at 8-byte aligned data, and advance data to the end of them.
+    void Map(const char*& data) {
+        size_t id_width;
+        std::memcpy(&id_width, data, sizeof(id_width));
+        _check_id_width(id_width);
+        data += sizeof(id_width);
+        base_ = MappedArray<id_type>::Map(data);
+        next_ = MappedArray<id_type>::Map(data);
+        check_ = MappedArray<uint8_t>::Map(data);
+    }
+    
+    bool is_mapped() const {return check_.is_mapped();}
+    
+private:
+    static void _check_id_width(size_t id_width) {
+        if (id_width != sizeof(id_type))
+            throw std::runtime_error("Id width of factor oracle is different from written one.");
+    }
+    
 };
 
 
@@ -252,7 +345,7 @@ private:
     std::string_view str_;
     size_t pos_;
     
-    friend class FactorOracle;
+    template <typename> friend class BasicFactorOracle;
     
 public:
     FactorOracleExproler(std::string_view str) : str_(str), pos_(0) {}
@@ -268,20 +361,41 @@ public:
 };
 
 
-class FactorOracle : FactorOracleBaseCTAFO {
+template <typename IdType>
+class BasicFactorOracle : FactorOracleBaseCTAFO<IdType> {
 public:
-    using Base = FactorOracleBaseCTAFO;
+    using Base = FactorOracleBaseCTAFO<IdType>;
     using Exproler = FactorOracleExproler;
+    using id_type = typename Base::id_type;
     
-    FactorOracle(const std::string& text) : Base(text) {}
+    using Base::size_in_bytes;
+    using Base::Read;
+    using Base::Write;
+    using Base::is_mapped;
+    
+    BasicFactorOracle(const std::string& text) : Base(text) {}
+    
+    explicit BasicFactorOracle(std::istream& is) : Base(is) {}
+    
+    // Oracle referring to data written by Write(), which must outlive it.
+    static BasicFactorOracle Map(const void* data) {
+        BasicFactorOracle oracle;
+        auto pos = static_cast<const char*>(data);
+        oracle.Base::Map(pos);
+        return oracle;
+    }
     
     template <class InputIter,
               typename IterTraits = std::iterator_traits<InputIter>,
               typename CharTraits = std::char_traits<typename IterTraits::value_type>>
-    FactorOracle(InputIter begin, InputIter end) : Base(begin, end) {}
+    BasicFactorOracle(InputIter begin, InputIter end) : Base(begin, end) {}
     
+private:
+    BasicFactorOracle() = default;
+    
+public:
     bool image(size_t& state, uint8_t c) const {
-        if (Base::check(state + 1) == c) {
+        if (state + 1 < Base::num_states() and Base::check(state + 1) == c) {
             state++;
         } else {
             auto b = Base::base(state);
@@ -297,6 +411,17 @@ public:
         return true;
     }
     
+    /* Continue reading chunk from state, which is 0 at the beginning of text.
+     * Text arriving in chunks is read as a whole by carrying state over the chunks.
+     */
+    bool feed(size_t& state, std::string_view chunk) const {
+        for (uint8_t c : chunk) {
+            if (not image(state, c))
+                return false;
+        }
+        return true;
+    }
+    
     bool accept(Exproler& exp) const {
         size_t state = 0;
         for (; exp.pos_ < exp.size(); exp.pos_++) {
@@ -313,6 +438,10 @@ public:
     
 };
 
+// Construction throws std::length_error when slots exceed ids of 32 bits.
+using FactorOracle = BasicFactorOracle<uint32_t>;
+using FactorOracle64 = BasicFactorOracle<uint64_t>;
+
 }
 
 #endif /* FactorOracle_hpp */
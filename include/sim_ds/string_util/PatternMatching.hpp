@@ -9,8 +9,14 @@
 #define PatternMatching_hpp
 
 #include "sim_ds/basic.hpp"
+#include "sim_ds/sort.hpp"
 #include "sim_ds/string_util/FactorOracle.hpp"
 
+#include <numeric>
+#include <optional>
+#include <unordered_map>
+#include <variant>
+
 namespace sim_ds {
 
 namespace pattern_matching {
@@ -37,30 +43,87 @@ public:
 _PatternMatchingBase::~_PatternMatchingBase() {}
 
 
+/* Algorithms enumerate matches by for_each_match(text, callback) without allocation,
+ * where callback returning false stops the enumeration. Following helpers build the others:
+ * count, find_first, and find_all into a vector or an output iterator.
+ */
+template <class Callback, class Match>
+inline bool _emit(Callback& callback, const Match& match) {
+    if constexpr (std::is_same_v<std::invoke_result_t<Callback&, const Match&>, void>) {
+        callback(match);
+        return true;
+    } else {
+        return callback(match);
+    }
+}
+
+template <typename Match, class Matcher>
+inline std::vector<Match> _collect_matches(const Matcher& matcher, std::string_view text) {
+    std::vector<Match> matchies;
+    matcher.for_each_match(text, [&](const Match& m) {matchies.push_back(m);});
+    return matchies;
+}
+
+template <class Matcher, class OutputIter>
+inline OutputIter _copy_matches(const Matcher& matcher, std::string_view text, OutputIter out) {
+    matcher.for_each_match(text, [&](const auto& m) {*out++ = m;});
+    return out;
+}
+
+template <class Matcher>
+inline size_t _count_matches(const Matcher& matcher, std::string_view text) {
+    size_t cnt = 0;
+    matcher.for_each_match(text, [&](const auto&) {cnt++;});
+    return cnt;
+}
+
+template <typename Match, class Matcher>
+inline std::optional<Match> _find_first_match(const Matcher& matcher, std::string_view text) {
+    std::optional<Match> first;
+    matcher.for_each_match(text, [&](const Match& m) {
+        first = m;
+        return false;
+    });
+    return first;
+}
+
+
 // MARK: Simple
 
 class Simple : private _PatternMatchingBase {
 public:
     Simple(std::string_view key) : _PatternMatchingBase(key) {}
     
-    std::vector<size_t> find_all(std::string_view text) const override;
+    template <class Callback>
+    void for_each_match(std::string_view text, Callback callback) const;
+    
+    std::vector<size_t> find_all(std::string_view text) const override {return _collect_matches<size_t>(*this, text);}
+    
+    template <class OutputIter>
+    OutputIter find_all(std::string_view text, OutputIter out) const {return _copy_matches(*this, text, out);}
+    
+    size_t count(std::string_view text) const {return _count_matches(*this, text);}
+    
+    std::optional<size_t> find_first(std::string_view text) const {return _find_first_match<size_t>(*this, text);}
+    
+    size_t max_key_size() const {return key_size();}
     
 };
 
-std::vector<size_t>
-Simple::find_all(std::string_view text) const {
-    std::vector<size_t> matchies;
+template <class Callback>
+void
+Simple::for_each_match(std::string_view text, Callback callback) const {
     if (text.size() < key_.size())
-        return matchies;
+        return;
     const auto kSize = key_.size();
     for (size_t i = 0; i <= text.size() - kSize; i++) {
         size_t pos = 0;
         while (pos < kSize and key_[pos] == text[i + pos])
             pos++;
         if (pos == kSize) // match
-            matchies.push_back(i);
+            if (not _emit(callback, i))
+                return;
     }
-    return matchies;
 }
 
 
@@ -87,23 +150,36 @@ public:
     
     size_t next(size_t pos) const {return next_[pos];}
     
-    std::vector<size_t> find_all(std::string_view text) const override;
+    template <class Callback>
+    void for_each_match(std::string_view text, Callback callback) const;
+    
+    std::vector<size_t> find_all(std::string_view text) const override {return _collect_matches<size_t>(*this, text);}
+    
+    template <class OutputIter>
+    OutputIter find_all(std::string_view text, OutputIter out) const {return _copy_matches(*this, text, out);}
+    
+    size_t count(std::string_view text) const {return _count_matches(*this, text);}
+    
+    std::optional<size_t> find_first(std::string_view text) const {return _find_first_match<size_t>(*this, text);}
+    
+    size_t max_key_size() const {return key_size();}
     
 };
 
-std::vector<size_t>
-Kmp::find_all(std::string_view text) const {
-    std::vector<size_t> matchies;
+template <class Callback>
+void
+Kmp::for_each_match(std::string_view text, Callback callback) const {
     difference_type pos = 0;
     for (size_t i = 0; i < text.size(); i++) {
         while (pos > -1 and key_[pos] != text[i])
             pos = next_[pos];
         pos++;
         if (pos == difference_type(key_.size())) {
-            matchies.push_back(i + 1 - key_.size());
+            if (not _emit(callback, i + 1 - key_.size()))
+                return;
+            pos = next_[pos];
         }
     }
-    return matchies;
 }
 
 
@@ -114,23 +190,35 @@ private:
     std::vector<size_t> skip_;
     
 public:
-    Bm(std::string_view key) : _PatternMatchingBase(key), skip_(0xFF, key.size()) {
+    Bm(std::string_view key) : _PatternMatchingBase(key), skip_(0x100, key.size()) {
         for (size_t i = 0; i < key.size() - 1; i++) {
-            skip_[key[i]] = key.size() - i - 1;
+            skip_[uint8_t(key[i])] = key.size() - i - 1;
         }
     }
     
     size_t skip(uint8_t type) const {return skip_[type];}
     
-    std::vector<size_t> find_all(std::string_view text) const override;
+    template <class Callback>
+    void for_each_match(std::string_view text, Callback callback) const;
+    
+    std::vector<size_t> find_all(std::string_view text) const override {return _collect_matches<size_t>(*this, text);}
+    
+    template <class OutputIter>
+    OutputIter find_all(std::string_view text, OutputIter out) const {return _copy_matches(*this, text, out);}
+    
+    size_t count(std::string_view text) const {return _count_matches(*this, text);}
+    
+    std::optional<size_t> find_first(std::string_view text) const {return _find_first_match<size_t>(*this, text);}
+    
+    size_t max_key_size() const {return key_size();}
     
 };
 
-std::vector<size_t>
-Bm::find_all(std::string_view text) const {
+template <class Callback>
+void
+Bm::for_each_match(std::string_view text, Callback callback) const {
     const size_t kWindowSize = key_.size();
     
-    std::vector<size_t> matchies;
     difference_type i = kWindowSize - 1;
     while (i < difference_type(text.size())) {
         difference_type pos = i;
@@ -139,11 +227,11 @@ Bm::find_all(std::string_view text) const {
             pos--; k--;
         }
         if (k == -1) // match
-            matchies.push_back(pos + 1);
-        i += skip_[text[i]];
+            if (not _emit(callback, size_t(pos + 1)))
+                return;
+        i += skip_[uint8_t(text[i])];
         
     }
-    return matchies;
 }
 
 
@@ -156,15 +244,27 @@ protected:
 public:
     Bom(std::string_view key) : _PatternMatchingBase(key), oracle_(key.rbegin(), key.rend()) {}
     
-    std::vector<size_t> find_all(std::string_view text) const override;
+    template <class Callback>
+    void for_each_match(std::string_view text, Callback callback) const;
+    
+    std::vector<size_t> find_all(std::string_view text) const override {return _collect_matches<size_t>(*this, text);}
+    
+    template <class OutputIter>
+    OutputIter find_all(std::string_view text, OutputIter out) const {return _copy_matches(*this, text, out);}
+    
+    size_t count(std::string_view text) const {return _count_matches(*this, text);}
+    
+    std::optional<size_t> find_first(std::string_view text) const {return _find_first_match<size_t>(*this, text);}
+    
+    size_t max_key_size() const {return key_size();}
     
 };
 
-std::vector<size_t>
-Bom::find_all(std::string_view text) const {
+template <class Callback>
+void
+Bom::for_each_match(std::string_view text, Callback callback) const {
     const long long kWindowSize = key_.size();
     
-    std::vector<size_t> matchies;
     difference_type i = kWindowSize - 1;
     while (i < difference_type(text.size())) {
         size_t state = 0;
@@ -172,13 +272,13 @@ Bom::find_all(std::string_view text) const {
         while (pos > i - kWindowSize and oracle_.image(state, text[pos]))
             pos--;
         if (pos == i - kWindowSize) { // match
-            matchies.push_back(i + 1 - kWindowSize);
+            if (not _emit(callback, size_t(i + 1 - kWindowSize)))
+                return;
             i++;
         } else {
             i = pos + kWindowSize;
         }
     }
-    return matchies;
 }
 
 
@@ -195,7 +295,17 @@ private:
 public:
     TurboBom(std::string_view key) : Bom(key), kmp_(key) {}
     
-    std::vector<size_t> find_all(std::string_view text) const override;
+    template <class Callback>
+    void for_each_match(std::string_view text, Callback callback) const;
+    
+    std::vector<size_t> find_all(std::string_view text) const override {return _collect_matches<size_t>(*this, text);}
+    
+    template <class OutputIter>
+    OutputIter find_all(std::string_view text, OutputIter out) const {return _copy_matches(*this, text, out);}
+    
+    size_t count(std::string_view text) const {return _count_matches(*this, text);}
+    
+    std::optional<size_t> find_first(std::string_view text) const {return _find_first_match<size_t>(*this, text);}
     
 private:
     long long kmp_search(std::string_view text, difference_type pos = 0) const {
@@ -209,12 +319,12 @@ private:
     
 };
 
-std::vector<size_t>
-TurboBom::find_all(std::string_view text) const {
+template <class Callback>
+void
+TurboBom::for_each_match(std::string_view text, Callback callback) const {
     const long long kWindowSize = key_.size();
     const long long kKmpWindowSize = kAlpha * kWindowSize;
     
-    std::vector<size_t> matchies;
     difference_type back = kWindowSize - 1;
     difference_type critpos = 0;
     while (back < difference_type(text.size())) {
@@ -225,7 +335,8 @@ TurboBom::find_all(std::string_view text) const {
             pos--;
         pos++;
         if (pos == begin) { // match
-            matchies.push_back(begin);
+            if (not _emit(callback, size_t(begin)))
+                return;
             critpos = back + 1;
             back += kWindowSize - kmp_.next(kWindowSize);
         } else {
@@ -236,10 +347,153 @@ TurboBom::find_all(std::string_view text) const {
             back = kmp_begin + kKmpWindowSize - next + kWindowSize - 1;
         }
     }
-    return matchies;
 }
 
 
+// MARK: Set-BOM
+
+/* Set Backward Oracle Matching for multiple keys.
+ * Windows are as long as the shortest key, and read backward on the oracle of reversed prefixes
+ * of keys cut to the window size. The oracle accepts at least all factors of the prefixes,
+ * so a failed read shifts the window past the failed position. The prefixes are joined by a byte
+ * absent from them if any, which only keeps factors across prefixes out of the oracle.
+ * Windows read through are verified against keys sharing the prefix.
+ *
+ * Keys must not contain '\0', the label reserved by the root of oracle.
+ */
+class SetBom {
+public:
+    using difference_type = long long;
+    
+    struct Match {
+        size_t pos;
+        size_t key_id;
+        
+        bool operator==(const Match& x) const {return pos == x.pos and key_id == x.key_id;}
+    };
+    
+private:
+    std::vector<std::string> keys_;
+    size_t min_key_size_;
+    size_t max_key_size_;
+    FactorOracle oracle_;
+    // Leading bytes (up to 8) of window to ids of keys beginning with them
+    std::unordered_map<uint64_t, std::vector<size_t>> candidates_;
+    
+public:
+    template <class InputIter>
+    SetBom(InputIter begin, InputIter end) : keys_(begin, end), min_key_size_(_min_key_size()), max_key_size_(_max_key_size()), oracle_(_reversed_prefixes()) {
+        for (size_t i = 0; i < keys_.size(); i++)
+            candidates_[_leading_bytes(keys_[i].data())].push_back(i);
+    }
+    
+    SetBom(const std::vector<std::string_view>& keys) : SetBom(keys.begin(), keys.end()) {}
+    
+    SetBom(const std::vector<std::string>& keys) : SetBom(keys.begin(), keys.end()) {}
+    
+    // Matches sorted by position, and by id of key on the same position.
+    template <class Callback>
+    void for_each_match(std::string_view text, Callback callback) const {
+        const difference_type kWindowSize = min_key_size_;
+        
+        difference_type i = kWindowSize - 1;
+        while (i < difference_type(text.size())) {
+            size_t state = 0;
+            difference_type pos = i;
+            while (pos > i - kWindowSize and oracle_.image(state, text[pos]))
+                pos--;
+            if (pos == i - kWindowSize) { // candidate
+                if (not _verify(text, pos + 1, callback))
+                    return;
+                i++;
+            } else {
+                i = pos + kWindowSize;
+            }
+        }
+    }
+    
+    std::vector<Match> find_all(std::string_view text) const {return _collect_matches<Match>(*this, text);}
+    
+    template <class OutputIter>
+    OutputIter find_all(std::string_view text, OutputIter out) const {return _copy_matches(*this, text, out);}
+    
+    size_t count(std::string_view text) const {return _count_matches(*this, text);}
+    
+    std::optional<Match> find_first(std::string_view text) const {return _find_first_match<Match>(*this, text);}
+    
+    size_t num_keys() const {return keys_.size();}
+    
+    std::string_view key(size_t id) const {return keys_[id];}
+    
+    size_t min_key_size() const {return min_key_size_;}
+    
+    size_t max_key_size() const {return max_key_size_;}
+    
+private:
+    uint64_t _leading_bytes(const char* str) const {
+        uint64_t bytes = 0;
+        std::memcpy(&bytes, str, std::min<size_t>(min_key_size_, sizeof(uint64_t)));
+        return bytes;
+    }
+    
+    size_t _min_key_size() const {
+        assert(not keys_.empty());
+        size_t size = std::numeric_limits<size_t>::max();
+        for (auto& key : keys_)
+            size = std::min(size, key.size());
+        assert(size > 0);
+        return size;
+    }
+    
+    size_t _max_key_size() const {
+        size_t size = 0;
+        for (auto& key : keys_)
+            size = std::max(size, key.size());
+        return size;
+    }
+    
+    std::string _reversed_prefixes() const {
+        std::array<bool, 0x100> appeared = {};
+        for (auto& key : keys_) {
+            if (key.find('\0') != std::string::npos)
+                throw std::invalid_argument("SetBom: keys must not contain '\\0'.");
+            for (size_t i = 0; i < min_key_size_; i++)
+                appeared[uint8_t(key[i])] = true;
+        }
+        // Label 0 is reserved by the root of oracle. When every other byte appears, prefixes are
+        // joined directly, and the oracle accepts also factors across them.
+        std::optional<char> delimiter;
+        for (size_t c = 0xFF; c > 0; c--) {
+            if (not appeared[c]) {
+                delimiter = char(c);
+                break;
+            }
+        }
+        std::string text;
+        text.reserve(keys_.size() * (min_key_size_ + 1));
+        for (auto& key : keys_) {
+            if (not text.empty() and delimiter)
+                text.push_back(*delimiter);
+            std::reverse_copy(key.begin(), key.begin() + min_key_size_, std::back_inserter(text));
+        }
+        return text;
+    }
+    
+    template <class Callback>
+    bool _verify(std::string_view text, size_t pos, Callback& callback) const {
+        auto it = candidates_.find(_leading_bytes(text.data() + pos));
+        if (it == candidates_.end())
+            return true;
+        for (auto id : it->second) {
+            if (text.substr(pos, keys_[id].size()) == keys_[id] and not _emit(callback, Match{pos, id}))
+                return false;
+        }
+        return true;
+    }
+    
+};
+
+
 // MARK: Sunday
 
 class Sunday : protected _PatternMatchingBase {
@@ -258,19 +512,18 @@ public:
                     break;
             min_shift[i] = i - j;
         }
-        auto maxshift_comp = [&](const Pat& l, const Pat& r) -> bool {
-            auto lms = min_shift[l.first], rms = min_shift[r.first];
-            return lms != rms ? lms < rms : l.first < r.first;
-        };
         for (size_t i = 0; i < key_.size(); i++)
             pattern_.emplace_back(i, key[i]);
-        std::sort(pattern_.begin(), pattern_.end(), maxshift_comp);
+        // Stable sort keeps positions ascending within the same shift.
+        RadixSort(pattern_.begin(), pattern_.end(), [&](const Pat& p) {return min_shift[p.first];});
     }
     
     virtual ~Sunday();
     
     const Pat* ordered_pattern(size_t num) const {return &pattern_[num];}
     
+    size_t max_key_size() const {return key_size();}
+    
 };
 Sunday::~Sunday() {}
 
@@ -283,36 +536,48 @@ public:
     // Deltas like improved bm skip function
     SundayQS(std::string_view key) : Sunday(key) {
         const size_t kKeySize = key_.size();
-        td1_.assign(0xFF, kKeySize + 1);
+        td1_.assign(0x100, kKeySize + 1);
         for (size_t i = 0; i < key_.size(); i++)
-            td1_[key_[i]] = kKeySize - i;
+            td1_[uint8_t(key_[i])] = kKeySize - i;
     }
     
     size_t delta1(uint8_t type) const {return td1_[type];}
     
-    std::vector<size_t> find_all(std::string_view text) const override;
+    template <class Callback>
+    void for_each_match(std::string_view text, Callback callback) const;
+    
+    std::vector<size_t> find_all(std::string_view text) const override {return _collect_matches<size_t>(*this, text);}
+    
+    template <class OutputIter>
+    OutputIter find_all(std::string_view text, OutputIter out) const {return _copy_matches(*this, text, out);}
+    
+    size_t count(std::string_view text) const {return _count_matches(*this, text);}
+    
+    std::optional<size_t> find_first(std::string_view text) const {return _find_first_match<size_t>(*this, text);}
  
 };
 
-std::vector<size_t>
-SundayQS::find_all(std::string_view text) const {
+template <class Callback>
+void
+SundayQS::for_each_match(std::string_view text, Callback callback) const {
     const size_t kKeySize = key_.size();
+    if (text.size() < kKeySize)
+        return;
     
-    std::vector<size_t> matchies;
     size_t i = 0;
     while (i <= text.size() - kKeySize) {
         size_t pos = 0;
         auto* pat = ordered_pattern(pos);
-        while (pos < kKeySize and pat->second == text[i + pat->first]) {
+        while (pos < kKeySize and pat->second == uint8_t(text[i + pat->first])) {
             pos++; ++pat;
         }
         if (pos == kKeySize)
-            matchies.push_back(i);
+            if (not _emit(callback, i))
+                return;
         if (i + kKeySize == text.size())
             break;
         i += delta1(text[i + kKeySize]);
     }
-    return matchies;
 }
 
 
@@ -362,32 +627,381 @@ public:
     
     size_t delta2(size_t pos) const {return td2_[pos];}
     
-    std::vector<size_t> find_all(std::string_view text) const override;
+    template <class Callback>
+    void for_each_match(std::string_view text, Callback callback) const;
+    
+    std::vector<size_t> find_all(std::string_view text) const override {return _collect_matches<size_t>(*this, text);}
+    
+    template <class OutputIter>
+    OutputIter find_all(std::string_view text, OutputIter out) const {return _copy_matches(*this, text, out);}
+    
+    size_t count(std::string_view text) const {return _count_matches(*this, text);}
+    
+    std::optional<size_t> find_first(std::string_view text) const {return _find_first_match<size_t>(*this, text);}
     
 };
 
-std::vector<size_t>
-SundayMS::find_all(std::string_view text) const {
+template <class Callback>
+void
+SundayMS::for_each_match(std::string_view text, Callback callback) const {
     const size_t kKeySize = key_.size();
+    if (text.size() < kKeySize)
+        return;
     
-    std::vector<size_t> matchies;
     size_t i = 0;
     while (i <= text.size() - kKeySize) {
         size_t pos = 0;
         auto* pat = ordered_pattern(pos);
-        while (pos < kKeySize and pat->second == text[i + pat->first]) {
+        while (pos < kKeySize and pat->second == uint8_t(text[i + pat->first])) {
             pos++; ++pat;
         }
         if (pos == kKeySize)
-            matchies.push_back(i);
+            if (not _emit(callback, i))
+                return;
         if (i + kKeySize == text.size())
             break;
         i += std::max(delta1(text[i + kKeySize]), delta2(pos));
     }
-    return matchies;
 }
 
 
+// MARK: SIMD
+
+/* Filter of windows by the first and the last bytes of key, verifying the rest of survivors.
+ * With AVX2, 32 windows are filtered at once by comparing bytes at their heads and tails.
+ * Two bytes apart by the key length rarely coincide both in text, so that verification is rare
+ * besides for keys of frequent bytes, where skipping algorithms do better.
+ */
+class Simd : protected _PatternMatchingBase {
+public:
+    Simd(std::string_view key) : _PatternMatchingBase(key) {
+        assert(not key.empty());
+    }
+    
+    template <class Callback>
+    void for_each_match(std::string_view text, Callback callback) const {
+        const size_t kKeySize = key_.size();
+        
+        if (text.size() < kKeySize)
+            return;
+        const size_t kNumWindows = text.size() - kKeySize + 1;
+        auto verify = [&](size_t pos) {
+            return kKeySize < 3 or std::memcmp(text.data() + pos + 1, key_.data() + 1, kKeySize - 2) == 0;
+        };
+        size_t i = 0;
+#ifdef __AVX2__
+        const auto first = _mm256_set1_epi8(key_.front());
+        const auto last = _mm256_set1_epi8(key_.back());
+        for (; i + 32 <= kNumWindows; i += 32) {
+            auto heads = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(text.data() + i));
+            auto tails = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(text.data() + i + kKeySize - 1));
+            uint32_t candidates = _mm256_movemask_epi8(_mm256_and_si256(_mm256_cmpeq_epi8(heads, first),
+                                                                        _mm256_cmpeq_epi8(tails, last)));
+            for (; candidates; candidates &= candidates - 1) {
+                size_t pos = i + bit_util::ctz(candidates);
+                if (verify(pos) and not _emit(callback, pos))
+                    return;
+            }
+        }
+#endif
+        for (; i < kNumWindows; i++) {
+            if (text[i] == key_.front() and text[i + kKeySize - 1] == key_.back() and verify(i) and not _emit(callback, i))
+                return;
+        }
+    }
+    
+    std::vector<size_t> find_all(std::string_view text) const override {return _collect_matches<size_t>(*this, text);}
+    
+    template <class OutputIter>
+    OutputIter find_all(std::string_view text, OutputIter out) const {return _copy_matches(*this, text, out);}
+    
+    size_t count(std::string_view text) const {return _count_matches(*this, text);}
+    
+    std::optional<size_t> find_first(std::string_view text) const {return _find_first_match<size_t>(*this, text);}
+    
+    size_t max_key_size() const {return key_size();}
+    
+};
+
+
+// MARK: Auto
+
+/* Matcher selecting an algorithm by key.
+ * Skipping algorithms skip windows at most by the key length, so with AVX2, Simd filtering 32
+ * windows at once wins besides long keys over small alphabets, where Bom reading windows
+ * backward skips nearly by the key length. Without AVX2, SundayQS wins over large alphabets
+ * and Bom over small ones besides short keys.
+ * Alphabet of text is estimated by bytes appearing in key.
+ */
+class Auto {
+public:
+#ifdef __AVX2__
+    static constexpr size_t kMinBomKeySize = 64;
+#else
+    static constexpr size_t kMinBomKeySize = 8;
+#endif
+    static constexpr size_t kMaxSmallAlphabet = 8;
+    
+private:
+    std::variant<Simd, Bom, SundayQS> matcher_;
+    
+public:
+    Auto(std::string_view key) : matcher_(_select(key)) {}
+    
+    template <class Callback>
+    void for_each_match(std::string_view text, Callback callback) const {
+        std::visit([&](auto& matcher) {matcher.for_each_match(text, callback);}, matcher_);
+    }
+    
+    std::vector<size_t> find_all(std::string_view text) const {return _collect_matches<size_t>(*this, text);}
+    
+    template <class OutputIter>
+    OutputIter find_all(std::string_view text, OutputIter out) const {return _copy_matches(*this, text, out);}
+    
+    size_t count(std::string_view text) const {return _count_matches(*this, text);}
+    
+    std::optional<size_t> find_first(std::string_view text) const {return _find_first_match<size_t>(*this, text);}
+    
+    const char* algorithm() const {
+        static constexpr const char* kNames[] = {"Simd", "Bom", "SundayQS"};
+        return kNames[matcher_.index()];
+    }
+    
+    size_t max_key_size() const {
+        return std::visit([&](auto& matcher) {return matcher.max_key_size();}, matcher_);
+    }
+    
+private:
+    static std::variant<Simd, Bom, SundayQS> _select(std::string_view key) {
+        std::array<bool, 0x100> appeared = {};
+        size_t alphabet_size = 0;
+        for (uint8_t c : key) {
+            alphabet_size += not appeared[c];
+            appeared[c] = true;
+        }
+        // Repeating bytes in key as well
+        bool small_alphabet = alphabet_size <= kMaxSmallAlphabet and alphabet_size * 2 <= key.size();
+        if (small_alphabet and key.size() >= kMinBomKeySize)
+            return Bom(key);
+#ifdef __AVX2__
+        return Simd(key);
+#else
+        if (key.size() < 3 and not small_alphabet)
+            return Simd(key);
+        return SundayQS(key);
+#endif
+    }
+    
+};
+
+
+// MARK: - Streaming
+
+inline size_t& _match_position(size_t& match) {return match;}
+
+inline size_t& _match_position(SetBom::Match& match) {return match.pos;}
+
+template <class Matcher>
+inline size_t _match_size(const Matcher& matcher, size_t) {return matcher.max_key_size();}
+
+inline size_t _match_size(const SetBom& matcher, const SetBom::Match& match) {return matcher.key(match.key_id).size();}
+
+/* Matcher of text arriving in chunks, such as network buffers.
+ * Each match is reported once by feed() of the chunk holding its last byte, positioned from
+ * the beginning of the stream. Matches of a feed are sorted by position, while a match of
+ * a long key may follow matches of shorter keys beginning after it in previous feeds. The last (max_key_size - 1) bytes fed are kept, and matches
+ * crossing the boundary are searched on them joined with the head of the next chunk,
+ * so that chunks themselves are searched in place.
+ * Matcher (such as Bom, Simd, Auto or SetBom) refers to its keys, which must outlive it.
+ */
+template <class Matcher>
+class StreamMatcher {
+public:
+    using matcher_type = Matcher;
+    using match_type = typename decltype(std::declval<const Matcher&>().find_all(std::string_view()))::value_type;
+    
+private:
+    Matcher matcher_;
+    std::string tail_;
+    std::string boundary_;
+    size_t consumed_ = 0;
+    
+public:
+    explicit StreamMatcher(Matcher matcher) : matcher_(std::move(matcher)) {}
+    
+    // Callback returning false skips the rest of matches in chunk, while chunk is still consumed.
+    template <class Callback>
+    void feed(std::string_view chunk, Callback callback) {
+        const size_t kOverlap = matcher_.max_key_size() - 1;
+        bool stopped = false;
+        if (not tail_.empty() and not chunk.empty()) {
+            boundary_ = tail_;
+            boundary_.append(chunk.substr(0, kOverlap));
+            matcher_.for_each_match(boundary_, [&](match_type m) {
+                auto& pos = _match_position(m);
+                if (pos >= tail_.size())
+                    return false;
+                if (pos + _match_size(matcher_, m) <= tail_.size())
+                    return true; // Reported with previous chunks
+                pos += consumed_ - tail_.size();
+                stopped = not _emit(callback, m);
+                return not stopped;
+            });
+        }
+        if (not stopped) {
+            matcher_.for_each_match(chunk, [&](match_type m) {
+                _match_position(m) += consumed_;
+                return _emit(callback, m);
+            });
+        }
+        
+        consumed_ += chunk.size();
+        if (chunk.size() >= kOverlap) {
+            tail_.assign(chunk.substr(chunk.size() - kOverlap));
+        } else {
+            tail_.append(chunk);
+            if (tail_.size() > kOverlap)
+                tail_.erase(0, tail_.size() - kOverlap);
+        }
+    }
+    
+    std::vector<match_type> feed(std::string_view chunk) {
+        std::vector<match_type> matchies;
+        feed(chunk, [&](const match_type& m) {matchies.push_back(m);});
+        return matchies;
+    }
+    
+    // Forget the stream to begin another one.
+    void reset() {
+        tail_.clear();
+        consumed_ = 0;
+    }
+    
+    size_t consumed() const {return consumed_;}
+    
+    const Matcher& matcher() const {return matcher_;}
+    
+};
+
+
+// MARK: - Parallel
+
+/* Matcher of large text on threads.
+ * Text is split into chunks, and each chunk is searched together with the following
+ * (max_key_size - 1) bytes, keeping matches beginning in the chunk, so that a match across
+ * a boundary is found once by the chunk of its beginning. Chunks outnumber threads to balance
+ * loads, and are taken by threads in turn. Matches are merged in order of chunks, that is the
+ * same order as Matcher itself as it reports matches sorted by position.
+ * Text shorter than two chunks of kMinChunkSize is searched by the caller alone.
+ */
+template <class Matcher>
+class ParallelMatcher {
+public:
+    using matcher_type = Matcher;
+    using match_type = typename decltype(std::declval<const Matcher&>().find_all(std::string_view()))::value_type;
+    static constexpr size_t kMinChunkSize = 1u << 16;
+    static constexpr size_t kChunksPerThread = 4;
+    
+private:
+    Matcher matcher_;
+    unsigned num_threads_;
+    
+public:
+    explicit ParallelMatcher(Matcher matcher, unsigned num_threads = std::thread::hardware_concurrency())
+    : matcher_(std::move(matcher)), num_threads_(std::max(num_threads, 1u)) {}
+    
+    // Text is searched entirely before callback is called in order on the caller.
+    template <class Callback>
+    void for_each_match(std::string_view text, Callback callback) const {
+        if (_num_chunks(text) == 1) {
+            matcher_.for_each_match(text, callback);
+            return;
+        }
+        for (auto& matchies : _find_chunks(text)) {
+            for (auto& m : matchies) {
+                if (not _emit(callback, m))
+                    return;
+            }
+        }
+    }
+    
+    std::vector<match_type> find_all(std::string_view text) const {
+        if (_num_chunks(text) == 1)
+            return matcher_.find_all(text);
+        auto chunk_matchies = _find_chunks(text);
+        size_t cnt = 0;
+        for (auto& matchies : chunk_matchies)
+            cnt += matchies.size();
+        std::vector<match_type> matchies;
+        matchies.reserve(cnt);
+        for (auto& m : chunk_matchies)
+            matchies.insert(matchies.end(), m.begin(), m.end());
+        return matchies;
+    }
+    
+    template <class OutputIter>
+    OutputIter find_all(std::string_view text, OutputIter out) const {return _copy_matches(*this, text, out);}
+    
+    size_t count(std::string_view text) const {
+        std::vector<size_t> counts(_num_chunks(text));
+        _search_chunks(text, [&](size_t c, std::string_view chunk, size_t chunk_size) {
+            _for_each_in_chunk(chunk, chunk_size, [&](const match_type&) {counts[c]++;});
+        });
+        return std::accumulate(counts.begin(), counts.end(), size_t(0));
+    }
+    
+    unsigned num_threads() const {return num_threads_;}
+    
+    const Matcher& matcher() const {return matcher_;}
+    
+private:
+    size_t _num_chunks(std::string_view text) const {
+        if (num_threads_ == 1)
+            return 1;
+        return std::max<size_t>(std::min<size_t>(num_threads_ * kChunksPerThread, text.size() / kMinChunkSize), 1);
+    }
+    
+    // Search of a chunk with its overlap, where matches beginning over chunk_size are dropped.
+    template <class Callback>
+    void _for_each_in_chunk(std::string_view chunk, size_t chunk_size, Callback callback) const {
+        matcher_.for_each_match(chunk, [&](match_type m) {
+            if (_match_position(m) >= chunk_size)
+                return false;
+            callback(m);
+            return true;
+        });
+    }
+    
+    // Call fn(c, chunk with overlap, size of chunk) for each chunk c on threads.
+    template <class Fn>
+    void _search_chunks(std::string_view text, Fn fn) const {
+        const size_t num_chunks = _num_chunks(text);
+        const size_t kOverlap = matcher_.max_key_size() - 1;
+        std::atomic<size_t> next_chunk{0};
+        _RunThreads(std::min<size_t>(num_threads_, num_chunks), [&](unsigned) {
+            for (size_t c; (c = next_chunk++) < num_chunks; ) {
+                size_t begin = text.size() * c / num_chunks;
+                size_t end = text.size() * (c+1) / num_chunks;
+                fn(c, text.substr(begin, end - begin + kOverlap), end - begin);
+            }
+        });
+    }
+    
+    std::vector<std::vector<match_type>> _find_chunks(std::string_view text) const {
+        std::vector<std::vector<match_type>> chunk_matchies(_num_chunks(text));
+        _search_chunks(text, [&](size_t c, std::string_view chunk, size_t chunk_size) {
+            size_t offset = chunk.data() - text.data();
+            _for_each_in_chunk(chunk, chunk_size, [&](match_type m) {
+                _match_position(m) += offset;
+                chunk_matchies[c].push_back(m);
+            });
+        });
+        return chunk_matchies;
+    }
+    
+};
+
+
 // MARK: - Pattern matching functions
 
 std::vector<size_t> PatternMatchSimple(std::string_view text, std::string_view key) {
@@ -418,6 +1032,18 @@ std::vector<size_t> PatternMatchSundayMS(std::string_view text, std::string_view
     return SundayMS(key).find_all(text);
 }
 
+std::vector<size_t> PatternMatchSIMD(std::string_view text, std::string_view key) {
+    return Simd(key).find_all(text);
+}
+
+std::vector<size_t> PatternMatchAuto(std::string_view text, std::string_view key) {
+    return Auto(key).find_all(text);
+}
+
+std::vector<SetBom::Match> PatternMatchSetBOM(std::string_view text, const std::vector<std::string_view>& keys) {
+    return SetBom(keys).find_all(text);
+}
+
 
 } // namespace pattern_matching
     
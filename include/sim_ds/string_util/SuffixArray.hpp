@@ -11,6 +11,7 @@
 #include "sim_ds/basic.hpp"
 #include "sim_ds/FitVector.hpp"
 #include "sim_ds/calc.hpp"
+#include "sim_ds/sort.hpp"
 
 #include <limits>
 
@@ -316,7 +317,7 @@ inline void SuffixArray::BuildLCP_() {
     
     size_t maxL = 0;
     long long sum = 0;
-    std::sort(lcp_arr.begin(), lcp_arr.end());
+    RadixSort(lcp_arr.begin(), lcp_arr.end());
     for (auto l : lcp_arr) {
         maxL = std::max(l, maxL);
         sum += l;
@@ -161,6 +161,10 @@ public:
         return container_[id];
     }
     
+    const item_type& item(size_type item_index) const {
+        return storage_[item_index];
+    }
+    
     const node_type& root() const {
         return node(kRootIndex);
     }
@@ -0,0 +1,96 @@
+//
+//  AhoCorasick_test.cpp
+//
+
+#include "gtest/gtest.h"
+#include "sim_ds/string_util/AhoCorasick.hpp"
+#include "sim_ds/string_util/PatternMatching.hpp"
+
+namespace {
+
+using Match = sim_ds::AhoCorasick::Match;
+
+std::vector<Match> answer(std::string_view text, const std::vector<std::string>& keys) {
+    std::vector<Match> matchies;
+    for (size_t id = 0; id < keys.size(); id++) {
+        for (auto pos : sim_ds::pattern_matching::PatternMatchSimple(text, keys[id]))
+            matchies.push_back({pos, id});
+    }
+    return matchies;
+}
+
+void sort_matchies(std::vector<Match>& matchies) {
+    std::sort(matchies.begin(), matchies.end(), [](auto& l, auto& r) {
+        return l.pos != r.pos ? l.pos < r.pos : l.key_id < r.key_id;
+    });
+}
+
+}
+
+TEST(AhoCorasickTest, sample) {
+    std::vector<std::string> keys = {"he", "she", "his", "hers"};
+    sim_ds::AhoCorasick ac(keys);
+    auto matchies = ac.find_all("ushers");
+    std::vector<Match> expected = {{1, 1}, {2, 0}, {2, 3}};
+    EXPECT_EQ(matchies.size(), expected.size());
+    sort_matchies(matchies);
+    EXPECT_EQ(matchies, expected);
+}
+
+TEST(AhoCorasickTest, random_keys) {
+    std::string text;
+    for (size_t i = 0; i < 0x10000; i++)
+        text.push_back(i % 5 ? 'a' + rand() % 4 : 0x80 + rand() % 64);
+    std::vector<std::string> keys;
+    for (size_t i = 0; i < 1000; i++) {
+        auto size = 1 + rand() % 12;
+        keys.push_back(text.substr(rand() % (text.size() - size), size));
+    }
+    // Distinct keys so that every id is reported.
+    std::sort(keys.begin(), keys.end());
+    keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+    std::shuffle(keys.begin(), keys.end(), std::mt19937(0));
+    sim_ds::AhoCorasick ac(keys);
+    EXPECT_EQ(ac.num_keys(), keys.size());
+    
+    auto expected = answer(text, keys);
+    sort_matchies(expected);
+    auto matchies = ac.find_all(text);
+    sort_matchies(matchies);
+    EXPECT_EQ(matchies, expected);
+    matchies = ac.find_all_prefiltered(text);
+    sort_matchies(matchies);
+    EXPECT_EQ(matchies, expected);
+}
+
+TEST(AhoCorasickTest, prefiltered_rare_heads) {
+    std::string text;
+    for (size_t i = 0; i < 0x10000; i++)
+        text.push_back('a' + rand() % 26);
+    std::vector<std::string> keys = {"qz", "xy", "jqk", "zzz", "q"};
+    sim_ds::AhoCorasick ac(keys);
+    auto matchies = ac.find_all_prefiltered(text);
+    EXPECT_EQ(matchies, ac.find_all(text));
+    sort_matchies(matchies);
+    auto expected = answer(text, keys);
+    sort_matchies(expected);
+    EXPECT_EQ(matchies, expected);
+}
+
+TEST(AhoCorasickTest, callbacks) {
+    std::vector<std::string> keys = {"he", "she", "his", "hers"};
+    sim_ds::AhoCorasick ac(keys);
+    std::string text = "ushers and his sheep";
+    auto matchies = ac.find_all(text);
+    EXPECT_EQ(ac.count(text), matchies.size());
+    EXPECT_EQ(*ac.find_first(text), matchies.front());
+    std::vector<Match> copied;
+    ac.find_all(text, std::back_inserter(copied));
+    EXPECT_EQ(copied, matchies);
+    size_t cnt = 0;
+    ac.for_each_match(text, [&](const Match&) {
+        return ++cnt < 2;
+    });
+    EXPECT_EQ(cnt, 2);
+    EXPECT_FALSE(ac.find_first("xyz").has_value());
+}
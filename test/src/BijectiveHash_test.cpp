@@ -0,0 +1,46 @@
+#include "gtest/gtest.h"
+#include "sim_ds/BijectiveHash.hpp"
+
+#include <random>
+
+namespace {
+
+template <unsigned Width>
+void TestHashWidth() {
+    constexpr size_t size = 1000;
+    constexpr uint64_t mask = Width < 64 ? (1ull<<Width)-1 : ~0ull;
+    std::mt19937_64 rnd(Width);
+    std::vector<uint64_t> keys(size);
+    for (auto& k : keys)
+        k = rnd() & mask;
+
+    sim_ds::SplitMixHash hasher(Width);
+    sim_ds::StaticSplitMixHash<Width> static_hasher;
+    std::vector<uint64_t> hs(size), static_hs(size);
+    hasher.hash(keys.data(), hs.data(), size);
+    static_hasher.hash(keys.data(), static_hs.data(), size);
+    for (size_t i = 0; i < size; i++) {
+        auto h = hasher.hash(keys[i]);
+        EXPECT_EQ(hs[i], h);
+        EXPECT_EQ(static_hs[i], h);
+        EXPECT_EQ(static_hasher.hash(keys[i]), h);
+        EXPECT_LE(h, mask);
+        EXPECT_EQ(hasher.ihash(h), keys[i]);
+    }
+    hasher.ihash(hs.data(), hs.data(), size);
+    static_hasher.ihash(static_hs.data(), static_hs.data(), size);
+    EXPECT_EQ(hs, keys);
+    EXPECT_EQ(static_hs, keys);
+}
+
+}
+
+TEST(BijectiveHash, SplitMixHashBatch) {
+    TestHashWidth<1>();
+    TestHashWidth<7>();
+    TestHashWidth<16>();
+    TestHashWidth<32>();
+    TestHashWidth<33>();
+    TestHashWidth<40>();
+    TestHashWidth<63>();
+}
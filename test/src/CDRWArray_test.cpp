@@ -1,6 +1,8 @@
 #include "gtest/gtest.h"
 #include "sim_ds/CDRWArray.hpp"
 
+#include <random>
+
 using namespace sim_ds;
 
 TEST(FitVectorTest, ConvertVector) {
@@ -14,3 +16,99 @@ TEST(FitVectorTest, ConvertVector) {
         EXPECT_EQ(source[i], vector.get(i));
 }
 
+
+TEST(BlockedCDRWArrayTest, ConvertVector) {
+    const auto size = 0x10000;
+
+    std::vector<uint64_t> source(size);
+    for (auto i = 0; i < size; i++)
+        source[i] = (1U << (rand() % 18)) - 1;
+    BlockedCDRWArray vector(source.begin(), source.end());
+    for (auto i = 0; i < size; i++)
+        EXPECT_EQ(source[i], vector.get(i));
+}
+
+TEST(BlockedCDRWArrayTest, SetRandomWidth) {
+    const auto size = 0x10000 + 7;
+
+    std::mt19937_64 rnd(0);
+    std::vector<uint64_t> source(size);
+    BlockedCDRWArray vector(size);
+    // Widths drift upward then downward so that blocks are rewritten and the pool is compacted.
+    for (unsigned max_width : {4, 16, 64, 8}) {
+        for (auto t = 0; t < size*2; t++) {
+            auto i = rnd() % size;
+            auto w = rnd() % (max_width + 1);
+            source[i] = w == 0 ? 0 : rnd() & bit_util::WidthMask(w);
+            vector.set(i, source[i]);
+        }
+        for (auto i = 0; i < size; i++)
+            EXPECT_EQ(source[i], vector.get(i));
+    }
+}
+
+TEST(CDRWArrayTest, SetDifferentWidth) {
+    const auto size = 0x1000;
+
+    std::mt19937_64 rnd(0);
+    std::vector<uint64_t> source(size);
+    CDRWArray vector(size);
+    for (auto t = 0; t < size*4; t++) {
+        auto i = rnd() % size;
+        source[i] = rnd() >> (rnd() % 64);
+        vector.set(i, source[i]);
+    }
+    for (auto i = 0; i < size; i++)
+        EXPECT_EQ(source[i], vector.get(i));
+}
+
+TEST(CDRWVectorTest, PushPopSet) {
+    const size_t size = 0x30000;
+
+    std::mt19937_64 rnd(0);
+    std::vector<uint64_t> source;
+    CDRWVector vector;
+    for (size_t i = 0; i < size; i++) {
+        source.push_back(rnd() >> (rnd() % 64));
+        vector.push_back(source.back());
+    }
+    EXPECT_EQ(vector.size(), size);
+    EXPECT_GE(vector.capacity(), size);
+    for (size_t t = 0; t < size; t++) {
+        auto i = rnd() % size;
+        source[i] = rnd() >> (rnd() % 64);
+        vector.set(i, source[i]);
+    }
+    for (size_t i = 0; i < size; i++)
+        EXPECT_EQ(source[i], vector.get(i));
+
+    for (size_t i = 0; i < size - 100; i++) {
+        source.pop_back();
+        vector.pop_back();
+    }
+    EXPECT_EQ(vector.size(), 100);
+    EXPECT_LE(vector.capacity(), 256);
+    vector.resize(1000);
+    source.resize(1000);
+    for (size_t i = 0; i < 1000; i++)
+        EXPECT_EQ(source[i], vector.get(i));
+}
+
+TEST(CDRWArrayTest, BuildAndSet) {
+    const auto size = 0x10000;
+
+    std::mt19937_64 rnd(0);
+    std::vector<uint64_t> source(size);
+    for (auto& v : source)
+        v = rnd() % 8 == 0 ? 0 : rnd() >> (rnd() % 64);
+    CDRWArray vector(source.begin(), source.end());
+    for (auto i = 0; i < size; i++)
+        EXPECT_EQ(source[i], vector.get(i));
+    for (auto t = 0; t < size; t++) {
+        auto i = rnd() % size;
+        source[i] = rnd() >> (rnd() % 64);
+        vector.set(i, source[i]);
+    }
+    for (auto i = 0; i < size; i++)
+        EXPECT_EQ(source[i], vector.get(i));
+}
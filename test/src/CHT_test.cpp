@@ -51,4 +51,136 @@ TEST(CHT, CHTSetGetGrow) {
             EXPECT_FALSE(s);
         }
     }
-}
\ No newline at end of file
+}
+
+TEST(CHT, CHTSetEraseGrowShrink) {
+    constexpr unsigned bits = 16;
+    constexpr size_t size = 1u<<bits;
+
+    std::vector<int> src(size, -1);
+    std::mt19937 rnd(0);
+    sim_ds::CHT<bits> cht(bits);
+    bool migrated = false;
+    size_t cnt = 0;
+    for (int t = 0; t < 4; t++) {
+        // Grow
+        for (int i = 0; i < size; i++) {
+            if (rnd()%2 == 0) {
+                if (src[i] == -1)
+                    cnt++;
+                src[i] = rnd()%size;
+                cht.set(i, src[i]);
+                migrated |= cht.migrating();
+            }
+        }
+        EXPECT_EQ(cht.size(), cnt);
+        for (int i = 0; i < size; i++) {
+            auto [s, v] = cht.get(i);
+            EXPECT_EQ(s, src[i] != -1);
+            if (s) {
+                EXPECT_EQ(v, src[i]);
+            }
+        }
+        // Shrink
+        for (int i = 0; i < size; i++) {
+            if (src[i] != -1 and rnd()%8 != 0) {
+                src[i] = -1;
+                cnt--;
+                cht.erase(i);
+                migrated |= cht.migrating();
+            }
+        }
+        EXPECT_EQ(cht.size(), cnt);
+        for (int i = 0; i < size; i++) {
+            auto [s, v] = cht.get(i);
+            EXPECT_EQ(s, src[i] != -1);
+            if (s) {
+                EXPECT_EQ(v, src[i]);
+            }
+        }
+    }
+    EXPECT_TRUE(migrated);
+}
+
+TEST(CHT, CHTSetGetBatch) {
+    constexpr unsigned bits = 16;
+    constexpr size_t size = 1u<<bits;
+
+    std::vector<int> src(size, -1);
+    std::mt19937 rnd(0);
+    sim_ds::CHT<bits> cht(bits);
+    for (int t = 0; t < 3; t++) {
+        // Batches include duplicated keys and keys already stored.
+        std::vector<uint64_t> keys, values;
+        for (int i = 0; i < size/2; i++) {
+            keys.push_back(rnd()%size);
+            values.push_back(rnd()%size);
+            src[keys.back()] = values.back();
+        }
+        cht.set_batch(keys.begin(), keys.end(), values.begin());
+        for (int i = 0; i < size; i += 3)
+            if (src[i] != -1) {
+                src[i] = -1;
+                cht.erase(i);
+            }
+    }
+    std::vector<uint64_t> keys(size);
+    std::iota(keys.begin(), keys.end(), 0);
+    std::vector<std::pair<bool, uint64_t>> res;
+    cht.get_batch(keys.begin(), keys.end(), std::back_inserter(res));
+    ASSERT_EQ(res.size(), size);
+    size_t cnt = 0;
+    for (int i = 0; i < size; i++) {
+        EXPECT_EQ(res[i].first, src[i] != -1);
+        if (src[i] != -1) {
+            EXPECT_EQ(res[i].second, src[i]);
+            cnt++;
+        }
+    }
+    EXPECT_EQ(cht.size(), cnt);
+}
+
+TEST(CHT, CHTBuildFromRange) {
+    std::mt19937 rnd(0);
+    // Small tables with dense keys wrap clusters around the end.
+    for (unsigned bits = 4; bits <= 16; bits += 4) {
+        for (int t = 0; t < 16; t++) {
+            size_t size = 1u<<bits;
+            std::vector<int> src(size, -1);
+            std::vector<std::pair<uint64_t, uint64_t>> kvs;
+            auto n = rnd() % (size*2);
+            for (size_t i = 0; i < n; i++) {
+                kvs.emplace_back(rnd()%size, rnd()%size);
+                src[kvs.back().first] = kvs.back().second;
+            }
+            sim_ds::CHT<16> cht(bits, kvs.begin(), kvs.end());
+            size_t cnt = 0;
+            for (size_t i = 0; i < size; i++) {
+                auto [s, v] = cht.get(i);
+                EXPECT_EQ(s, src[i] != -1);
+                if (s) {
+                    EXPECT_EQ(v, src[i]);
+                    cnt++;
+                }
+            }
+            EXPECT_EQ(cht.size(), cnt);
+            // Table built at once stays consistent for updates.
+            for (size_t i = 0; i < size; i++) {
+                if (src[i] == -1) {
+                    src[i] = i;
+                    cht.set(i, i);
+                } else {
+                    src[i] = -1;
+                    cht.erase(i);
+                }
+            }
+            for (size_t i = 0; i < size; i++) {
+                auto [s, v] = cht.get(i);
+                EXPECT_EQ(s, src[i] != -1);
+                if (s) {
+                    EXPECT_EQ(v, src[i]);
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,125 @@
+#include "gtest/gtest.h"
+#include "sim_ds/ConcurrentCHT.hpp"
+
+#include <random>
+#include <thread>
+
+TEST(ConcurrentCHT, SetGetErase) {
+    constexpr unsigned bits = 16;
+    constexpr size_t size = 1u<<bits;
+
+    std::vector<bool> src(size);
+    std::mt19937 rnd(0);
+    sim_ds::ConcurrentCHT<bits> cht(bits*2);
+    for (size_t i = 0; i < size; i++) {
+        if (rnd()%2 == 0) {
+            src[i] = true;
+            cht.set(uint64_t(i) << bits, i);
+        }
+    }
+    for (size_t i = 0; i < size; i++) {
+        if (src[i] and rnd()%4 != 0) {
+            src[i] = false;
+            cht.erase(uint64_t(i) << bits);
+        }
+    }
+    size_t cnt = 0;
+    for (size_t i = 0; i < size; i++) {
+        auto [s, v] = cht.get(uint64_t(i) << bits);
+        EXPECT_EQ(s, src[i]);
+        if (src[i]) {
+            EXPECT_EQ(v, i);
+            cnt++;
+        }
+    }
+    EXPECT_EQ(cht.size(), cnt);
+    cht.reclaim();
+}
+
+TEST(ConcurrentCHT, ConcurrentReadWrite) {
+    constexpr unsigned bits = 16;
+    constexpr size_t size = 1u<<bits;
+    constexpr unsigned num_writers = 2;
+    constexpr unsigned num_readers = 4;
+
+    // Keys of [0, size/2) are stable; the others are inserted by writers.
+    sim_ds::ConcurrentCHT<bits> cht(bits);
+    for (size_t i = 0; i < size/2; i++)
+        cht.set(i, i);
+
+    std::atomic<bool> failed = false;
+    std::vector<std::thread> threads;
+    for (unsigned w = 0; w < num_writers; w++) {
+        threads.emplace_back([&, w] {
+            for (size_t i = size/2 + w; i < size; i += num_writers)
+                cht.set(i, i);
+            for (size_t i = size/2 + w; i < size; i += num_writers*2)
+                cht.erase(i);
+        });
+    }
+    for (unsigned r = 0; r < num_readers; r++) {
+        threads.emplace_back([&, r] {
+            std::mt19937 rnd(r);
+            for (size_t t = 0; t < size*2; t++) {
+                auto key = rnd() % size;
+                auto [s, v] = cht.get(key);
+                if ((key < size/2 and !s) or (s and v != key))
+                    failed = true;
+            }
+        });
+    }
+    for (auto& t : threads)
+        t.join();
+    EXPECT_FALSE(failed);
+
+    for (size_t i = 0; i < size; i++) {
+        bool erased = i >= size/2 and (i - size/2) % (num_writers*2) < num_writers;
+        auto [s, v] = cht.get(i);
+        EXPECT_EQ(s, !erased);
+        if (s) {
+            EXPECT_EQ(v, i);
+        }
+    }
+    EXPECT_EQ(cht.size(), size - size/2/2);
+}
+
+TEST(ConcurrentCHT, InsertIntoTableOfTombstones) {
+    constexpr unsigned bits = 16;
+    constexpr unsigned num_readers = 4;
+
+    // A single segment of the default bucket is filled by 4 elements.
+    sim_ds::ConcurrentCHT<bits> cht(bits, bits, 0);
+    std::atomic<bool> done = false;
+    std::atomic<bool> failed = false;
+    std::vector<std::thread> readers;
+    for (unsigned r = 0; r < num_readers; r++) {
+        readers.emplace_back([&, r] {
+            std::mt19937 rnd(r);
+            while (!done) {
+                auto key = rnd() % 64;
+                auto [s, v] = cht.get(key);
+                if (s and v != key)
+                    failed = true;
+            }
+        });
+    }
+    for (uint64_t t = 0; t < 1000; t++) {
+        // Erased keys leave the table filled with tombstones only.
+        for (uint64_t i = 0; i < 4; i++)
+            cht.set((t + i) % 64, (t + i) % 64);
+        for (uint64_t i = 0; i < 4; i++)
+            cht.erase((t + i) % 64);
+        EXPECT_EQ(cht.size(), 0);
+        // A key other than tombstoned ones grows the table.
+        auto key = (t + 4) % 64;
+        cht.set(key, key);
+        auto [s, v] = cht.get(key);
+        EXPECT_TRUE(s);
+        EXPECT_EQ(v, key);
+        cht.erase(key);
+    }
+    done = true;
+    for (auto& t : readers)
+        t.join();
+    EXPECT_FALSE(failed);
+}
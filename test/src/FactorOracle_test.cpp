@@ -42,3 +42,94 @@ TEST(FactorOracleTest, full_exploration_large) {
         EXPECT_TRUE(fo.accept(text_view.substr(i)));
     }
 }
+
+TEST(FactorOracleTest, full_exploration_large_alphabet) {
+    // Many states with several transitions make conflicts in double array.
+    std::string text;
+    const size_t SIZE = 0x8000;
+    for (size_t i = 0; i < SIZE; i++) {
+        auto r = rand() % 64;
+        text.push_back(r < 32 ? 'a' + r % 8 : ' ' + r);
+    }
+    sim_ds::FactorOracle fo(text);
+    std::string_view text_view(text);
+    for (int i = 0; i < SIZE; i++) {
+        EXPECT_TRUE(fo.accept(text_view.substr(i)));
+    }
+}
+
+TEST(FactorOracleTest, feed_chunks) {
+    std::string_view text("abracatabra");
+    sim_ds::FactorOracle fo("abracatabra");
+    for (size_t i = 0; i < text.size(); i++) {
+        size_t state = 0;
+        EXPECT_TRUE(fo.feed(state, text.substr(0, i)));
+        EXPECT_TRUE(fo.feed(state, text.substr(i)));
+    }
+    size_t state = 0;
+    EXPECT_TRUE(fo.feed(state, "abra"));
+    EXPECT_FALSE(fo.feed(state, "abra"));
+}
+
+namespace {
+
+std::string random_text(size_t size) {
+    std::string text;
+    for (size_t i = 0; i < size; i++)
+        text.push_back('a' + rand() % 6);
+    return text;
+}
+
+}
+
+TEST(FactorOracleTest, read_write) {
+    auto text = random_text(0x1000);
+    sim_ds::FactorOracle fo(text);
+    std::stringstream ss;
+    fo.Write(ss);
+    sim_ds::FactorOracle loaded(ss);
+    EXPECT_FALSE(loaded.is_mapped());
+    EXPECT_EQ(loaded.size_in_bytes(), fo.size_in_bytes());
+    std::string_view text_view(text);
+    for (size_t i = 0; i < text.size(); i++) {
+        EXPECT_TRUE(loaded.accept(text_view.substr(i)));
+    }
+}
+
+TEST(FactorOracleTest, map_file) {
+    auto text = random_text(0x1000);
+    sim_ds::FactorOracle fo(text);
+    auto path = testing::TempDir() + "factor_oracle_map_file.bin";
+    {
+        std::ofstream ofs(path);
+        fo.Write(ofs);
+    }
+    sim_ds::MappedFile file(path);
+    auto mapped = sim_ds::FactorOracle::Map(file.data());
+    EXPECT_TRUE(mapped.is_mapped());
+    std::string_view text_view(text);
+    for (size_t i = 0; i < text.size(); i++) {
+        EXPECT_TRUE(mapped.accept(text_view.substr(i)));
+        size_t s1 = 0, s2 = 0;
+        auto key = random_text(4);
+        EXPECT_EQ(mapped.feed(s1, key), fo.feed(s2, key));
+    }
+    std::remove(path.c_str());
+}
+
+TEST(FactorOracleTest, id_width) {
+    auto text = random_text(0x1000);
+    sim_ds::BasicFactorOracle<uint16_t> fo16(text);
+    sim_ds::FactorOracle64 fo64(text);
+    EXPECT_LT(fo16.size_in_bytes(), fo64.size_in_bytes());
+    std::string_view text_view(text);
+    for (size_t i = 0; i < text.size(); i++) {
+        EXPECT_TRUE(fo16.accept(text_view.substr(i)));
+        EXPECT_TRUE(fo64.accept(text_view.substr(i)));
+    }
+    EXPECT_THROW(sim_ds::BasicFactorOracle<uint16_t>(random_text(0x10000)), std::length_error);
+    
+    std::stringstream ss;
+    fo16.Write(ss);
+    EXPECT_THROW(sim_ds::FactorOracle loaded(ss), std::runtime_error);
+}
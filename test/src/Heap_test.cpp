@@ -8,6 +8,8 @@
 #include "gtest/gtest.h"
 #include "sim_ds/Heap.hpp"
 
+#include <random>
+
 using sim_ds::MinHeap;
 using sim_ds::MaxHeap;
 
@@ -71,3 +73,93 @@ TEST(MaxHeapTest, iterator) {
         heap.pop();
     }
 }
+
+template <unsigned Arity>
+void TestDaryHeapRandom() {
+    std::mt19937 rnd(Arity);
+    std::vector<int> vec(1u<<14);
+    for (auto& v : vec)
+        v = rnd() % (1u<<10);
+    sim_ds::DaryHeap<int, std::less<int>, Arity> heap;
+    std::multiset<int> expected;
+    // Interleave pushes and pops.
+    for (size_t i = 0; i < vec.size(); i++) {
+        heap.push(vec[i]);
+        expected.insert(vec[i]);
+        if (i % 3 == 2) {
+            ASSERT_EQ(heap.top(), *expected.begin());
+            heap.pop();
+            expected.erase(expected.begin());
+        }
+    }
+    EXPECT_EQ(heap.size(), expected.size());
+    for (auto v : expected) {
+        ASSERT_EQ(heap.top(), v);
+        heap.pop();
+    }
+    sim_ds::DaryHeap<int, std::less<int>, Arity> built(vec.begin(), vec.end());
+    std::sort(vec.begin(), vec.end());
+    for (auto v : vec) {
+        ASSERT_EQ(built.top(), v);
+        built.pop();
+    }
+    EXPECT_TRUE(built.empty());
+}
+
+TEST(DaryHeapTest, Random) {
+    TestDaryHeapRandom<2>();
+    TestDaryHeapRandom<4>();
+    TestDaryHeapRandom<8>();
+}
+
+TEST(DaryHeapTest, Comparator) {
+    using Item = std::pair<double, std::string>;
+    auto later = [](const Item& l, const Item& r) {return l.first > r.first;};
+    sim_ds::DaryHeap<Item, decltype(later), 4> heap(later);
+    heap.push({0.5, "b"});
+    heap.push({2.0, "d"});
+    heap.push({-1.0, "a"});
+    heap.push({1.5, "c"});
+    for (auto s : {"d", "c", "b", "a"}) {
+        EXPECT_EQ(heap.top().second, s);
+        heap.pop();
+    }
+}
+
+TEST(IndexedHeapTest, DecreaseKey) {
+    constexpr size_t n = 1u<<12;
+    std::mt19937 rnd(0);
+    std::vector<int> key(n);
+    sim_ds::IndexedHeap<int> heap(n);
+    for (size_t i = 0; i < n; i++) {
+        key[i] = rnd() % (1u<<16);
+        heap.push(i, key[i]);
+    }
+    for (size_t t = 0; t < n; t++) {
+        auto id = rnd() % n;
+        if (rnd() % 2) {
+            key[id] -= rnd() % 64;
+            heap.decrease_key(id, key[id]);
+        } else {
+            key[id] = rnd() % (1u<<16);
+            heap.update(id, key[id]);
+        }
+    }
+    for (size_t i = 0; i < n; i += 5) {
+        heap.erase(i);
+        EXPECT_FALSE(heap.contains(i));
+    }
+    int prev = std::numeric_limits<int>::min();
+    size_t cnt = 0;
+    while (!heap.empty()) {
+        auto id = heap.top_id();
+        EXPECT_EQ(heap.top_key(), key[id]);
+        EXPECT_LE(prev, heap.top_key());
+        EXPECT_NE(id % 5, 0);
+        prev = heap.top_key();
+        heap.pop();
+        EXPECT_FALSE(heap.contains(id));
+        cnt++;
+    }
+    EXPECT_EQ(cnt, n - (n + 4) / 5);
+}
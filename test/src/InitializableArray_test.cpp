@@ -22,9 +22,44 @@ TEST(InitializableArrayTest, basic) {
         for (int j = 0; j < SIZE; j++) {
             EXPECT_EQ(arr.get(j), queries.count(j) ? queries[j] : init_v);
         }
+        std::map<int, int> set_elements;
+        arr.for_each([&](size_t index, int value) {
+            set_elements[index] = value;
+        });
+        EXPECT_EQ(set_elements, queries);
     }
 }
 
+TEST(InitializableArrayTest, CompactFolklore) {
+    sim_ds::CompactInitializableArrayFolklore<int> arr(SIZE);
+    for (int i = 0; i < LOOP; i++) {
+        int init_v = random()%SIZE;
+        arr.fill(init_v); // O(1)
+        std::map<int, int> queries;
+        for (int j = 0; j < SAMPLE_SIZE; j++) {
+            int id = random()%SIZE;
+            int v = random()%SIZE;
+            queries[id] = v;
+            arr.set(id, v);
+        }
+        for (int j = 0; j < SIZE; j++) {
+            EXPECT_EQ(arr.get(j), queries.count(j) ? queries[j] : init_v);
+        }
+        EXPECT_EQ(arr.num_set(), queries.size());
+        std::map<int, int> set_elements;
+        arr.for_each([&](size_t index, int value) {
+            EXPECT_TRUE(set_elements.emplace(index, value).second);
+        });
+        EXPECT_EQ(set_elements, queries);
+    }
+}
+
+TEST(InitializableArrayTest, CompactFolkloreIndexRange) {
+    using Array = sim_ds::CompactInitializableArrayFolklore<int, uint8_t>;
+    EXPECT_NO_THROW(Array(0x100));
+    EXPECT_THROW(Array(0x101), std::length_error);
+}
+
 TEST(InplaceInitializableArrayTest, basic) {
     sim_ds::InitializableArray<int, SIZE> arr;
     for (int i = 0; i < LOOP; i++) {
@@ -43,3 +78,64 @@ TEST(InplaceInitializableArrayTest, basic) {
         }
     }
 }
+
+TEST(InplaceInitializableArrayTest, GeneralCase) {
+    sim_ds::InitializableArray<uint8_t, SIZE> arr;
+    for (int i = 0; i < LOOP; i++) {
+        uint8_t init_v = random()%256;
+        arr.fill(init_v); // O(1)
+        std::map<int, uint8_t> queries;
+        for (int j = 0; j < SAMPLE_SIZE; j++) {
+            int id = random()%SIZE;
+            uint8_t v = random()%256;
+            queries[id] = v;
+            arr[id] = v;
+        }
+        for (int j = 0; j < SIZE; j++) {
+            EXPECT_EQ(arr[j], queries.count(j) ? queries[j] : init_v);
+        }
+    }
+}
+
+TEST(InplaceInitializableArrayTest, Bool) {
+    sim_ds::InitializableArray<bool, 1000> visited;
+    for (int i = 0; i < LOOP; i++) {
+        visited.fill(false); // O(1)
+        std::map<int, bool> queries;
+        for (int j = 0; j < SAMPLE_SIZE; j++) {
+            int id = random()%1000;
+            queries[id] = true;
+            visited[id] = true;
+        }
+        for (int j = 0; j < 1000; j++) {
+            EXPECT_EQ(visited[j], queries.count(j) > 0);
+        }
+    }
+    visited.fill(true);
+    visited[7] = false;
+    EXPECT_FALSE(visited[7]);
+    EXPECT_TRUE(visited[8]);
+}
+
+TEST(InitializableFitVectorTest, basic) {
+    for (unsigned width : {1, 3, 7, 13, 33, 64}) {
+        const size_t size = SIZE + width; // odd sizes too
+        sim_ds::InitializableFitVector arr(size, width);
+        auto mask = sim_ds::bit_util::WidthMask(width);
+        for (int i = 0; i < LOOP/16; i++) {
+            uint64_t init_v = random() & mask;
+            arr.init(init_v); // O(1)
+            std::map<size_t, uint64_t> queries;
+            for (int j = 0; j < SAMPLE_SIZE * (i%4); j++) {
+                size_t id = random()%size;
+                uint64_t v = ((uint64_t(random()) << 32) ^ random()) & mask;
+                queries[id] = v;
+                arr.set(id, v);
+            }
+            for (size_t j = 0; j < size; j++) {
+                EXPECT_EQ(arr.get(j), queries.count(j) ? queries[j] : init_v);
+            }
+        }
+        EXPECT_LE(arr.size_in_bytes(), (size * width + 7) / 8 + 128);
+    }
+}
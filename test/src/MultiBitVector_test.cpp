@@ -75,6 +75,53 @@ void testRank() {
     }
 }
 
+template <int TYPE_SIZE>
+void testRankAll(size_t size) {
+    MultiBitVector<TYPE_SIZE> multiBits;
+    std::mt19937 rnd(TYPE_SIZE);
+    const auto Max = 1U << TYPE_SIZE;
+    std::vector<uint8_t> src(size);
+    for (size_t i = 0; i < size; i++) {
+        // Skewed to small symbols, and some large symbols never appear.
+        src[i] = rnd() % 4 ? rnd() % std::min(Max, 4u) : rnd() % (Max - Max / 8);
+        multiBits.set(i, src[i]);
+    }
+    multiBits.build();
+    
+    std::vector<size_t> counts(Max, 0);
+    for (size_t i = 0; i <= size; i++) {
+        for (size_t c = 0; c < Max; c++) {
+            if (i % 7 == 0 or c == src[std::min(i, size - 1)]) {
+                ASSERT_EQ(counts[c], multiBits.rank(c, i));
+            }
+        }
+        if (i < size) {
+            EXPECT_EQ(src[i], multiBits[i]);
+            counts[src[i]]++;
+        }
+    }
+}
+
+template <int TYPE_SIZE, bool UseSelect>
+void testSelect(size_t size) {
+    MultiBitVector<TYPE_SIZE, UseSelect> multiBits;
+    std::mt19937 rnd(TYPE_SIZE);
+    const auto Max = 1U << TYPE_SIZE;
+    std::vector<std::vector<size_t>> positions(Max);
+    for (size_t i = 0; i < size; i++) {
+        // Long runs of a symbol leave tips without other symbols.
+        uint8_t c = (i / 4096) % 3 == 2 ? 1 : rnd() % Max;
+        positions[c].push_back(i);
+        multiBits.set(i, c);
+    }
+    multiBits.build();
+    
+    for (size_t c = 1; c < Max; c++) {
+        for (size_t i = 0; i < positions[c].size(); i++)
+            ASSERT_EQ(positions[c][i], multiBits.select(c, i));
+    }
+}
+
 TEST(MultiBitVectorTest, ElemTwo) {
     testElem<1>();
 }
@@ -98,3 +145,39 @@ TEST(MultiBitVectorTest, RankFour) {
 TEST(MultiBitVectorTest, RankEight) {
     testRank<3>();
 }
+
+TEST(MultiBitVectorTest, ElemSixteen) {
+    testElem<4>();
+}
+
+TEST(MultiBitVectorTest, ElemTwoFiftySix) {
+    testElem<8>();
+}
+
+TEST(MultiBitVectorTest, RankSixteen) {
+    testRank<4>();
+}
+
+TEST(MultiBitVectorTest, RankSymbols) {
+    for (size_t size : {1, 63, 64, 1000, 0x4000}) {
+        testRankAll<1>(size);
+        testRankAll<2>(size);
+        testRankAll<3>(size);
+        testRankAll<4>(size);
+        testRankAll<5>(size);
+        testRankAll<8>(size);
+    }
+}
+
+TEST(MultiBitVectorTest, Select) {
+    for (size_t size : {1, 1000, 0x10000}) {
+        testSelect<1, false>(size);
+        testSelect<1, true>(size);
+        testSelect<2, true>(size);
+        testSelect<3, false>(size);
+        testSelect<3, true>(size);
+        testSelect<4, false>(size);
+        testSelect<4, true>(size);
+        testSelect<8, true>(size);
+    }
+}
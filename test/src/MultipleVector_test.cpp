@@ -85,3 +85,102 @@ TEST(MultipleVectorTest, Operator) {
         EXPECT_EQ(check, check_src[i]);
     }
 }
+
+TEST(MultipleVectorTest, Widths) {
+    const auto size = 0x10000;
+    MultipleVector fva{1, 3, 8, 5, 2};
+    ColumnarMultipleVector cfva{1, 3, 8, 5, 2};
+    fva.resize(size);
+    cfva.resize(size);
+    std::vector<std::array<uint64_t, 5>> src(size);
+    for (auto i = 0; i < size; i++) {
+        auto& s = src[i];
+        s = {rand_vector(1, 8)[0], rand_vector(1, 24)[0], rand_vector(1, 64)[0], rand_vector(1, 40)[0], rand_vector(1, 16)[0]};
+        fva.block(i).set_at(0, s[0]);
+        fva.set_nested_element<1>(i, s[1]);
+        fva.block(i).template set<2>(s[2]);
+        fva.set_nested_element<3>(i, s[3]);
+        fva.set_nested_element<4>(i, s[4]);
+        cfva.set_nested_element<0>(i, s[0]);
+        cfva.set_nested_element<1>(i, s[1]);
+        cfva.set_nested_element<2>(i, s[2]);
+        cfva.set_nested_element<3>(i, s[3]);
+        cfva.set_nested_element<4>(i, s[4]);
+    }
+    for (auto i = 0; i < size; i++) {
+        EXPECT_EQ(fva.nested_element<0>(i), src[i][0]);
+        EXPECT_EQ(fva.block(i).template get<1>(), src[i][1]);
+        EXPECT_EQ(fva.nested_element<2>(i), src[i][2]);
+        EXPECT_EQ(fva.block(i).template get<3>(), src[i][3]);
+        EXPECT_EQ(fva.nested_element<4>(i), src[i][4]);
+        EXPECT_EQ(cfva.nested_element<0>(i), src[i][0]);
+        EXPECT_EQ(cfva.nested_element<1>(i), src[i][1]);
+        EXPECT_EQ(cfva.nested_element<2>(i), src[i][2]);
+        EXPECT_EQ(cfva.nested_element<3>(i), src[i][3]);
+        EXPECT_EQ(cfva.nested_element<4>(i), src[i][4]);
+    }
+    std::vector<uint64_t> row, column;
+    fva.copy_elements<3>(10, size, std::back_inserter(row));
+    cfva.copy_elements<3>(10, size, std::back_inserter(column));
+    ASSERT_EQ(row.size(), size - 10);
+    EXPECT_EQ(row, column);
+    for (auto i = 10; i < size; i++)
+        EXPECT_EQ(row[i - 10], src[i][3]);
+    
+    std::stringstream ss;
+    cfva.StoreTo(ss);
+    ColumnarMultipleVector loaded;
+    loaded.LoadFrom(ss);
+    ASSERT_EQ(loaded.size(), size);
+    for (auto i = 0; i < size; i++)
+        EXPECT_EQ(loaded.nested_element<1>(i), src[i][1]);
+}
+
+TEST(MultipleVectorTest, Static) {
+    const auto size = 0x10000;
+    
+    auto next_src = rand_vector(size, 32);
+    auto check_src = rand_vector(size, 8);
+    
+    StaticMultipleVector<4, 1> sfva;
+    static_assert(StaticMultipleVector<4, 1>::block_size() == 5);
+    sfva.resize(size);
+    for (auto i = 0; i < size; i++) {
+        if (i % 2) {
+            sfva.set_nested_element<0>(i, next_src[i]);
+            sfva.set_nested_element<1>(i, check_src[i]);
+        } else {
+            sfva.block(i).set_at(0, next_src[i]);
+            sfva.block(i).template set<1>(check_src[i]);
+        }
+    }
+    const auto& csfva = sfva;
+    for (auto i = 0; i < size; i++) {
+        EXPECT_EQ(csfva.nested_element<0>(i), next_src[i]);
+        EXPECT_EQ(csfva.block(i).template get<1>(), check_src[i]);
+        EXPECT_EQ(csfva.block(i).get_at(0), next_src[i]);
+    }
+    std::vector<uint64_t> checks;
+    csfva.copy_elements<1>(0, size, std::back_inserter(checks));
+    EXPECT_TRUE(std::equal(checks.begin(), checks.end(), check_src.begin()));
+    
+    // Serialized form is shared with MultipleVector.
+    std::stringstream ss;
+    sfva.StoreTo(ss);
+    MultipleVector fva;
+    fva.LoadFrom(ss);
+    ASSERT_EQ(fva.size(), size);
+    for (auto i = 0; i < size; i++) {
+        EXPECT_EQ(fva.nested_element<0>(i), next_src[i]);
+        EXPECT_EQ(fva.nested_element<1>(i), check_src[i]);
+    }
+    
+    // Data of other element sizes is rejected without touching the vector.
+    std::stringstream mismatched;
+    StaticMultipleVector<2, 2> other;
+    other.resize(size);
+    other.StoreTo(mismatched);
+    EXPECT_THROW(sfva.LoadFrom(mismatched), std::runtime_error);
+    ASSERT_EQ(sfva.size(), size);
+    EXPECT_EQ(csfva.nested_element<0>(size - 1), next_src[size - 1]);
+}
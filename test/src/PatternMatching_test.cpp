@@ -140,3 +140,202 @@ TEST(PatternMatching, SundayMS_large) {
         EXPECT_EQ(matchies[i], sample_answer_large[i]);
     }
 }
+
+namespace {
+
+const std::vector<std::string_view> sample_keys{"abcaba", "bcab", "abx", "cabca", "abxab"};
+
+std::vector<sim_ds::pattern_matching::SetBom::Match> set_answer(std::string_view text, const std::vector<std::string_view>& keys) {
+    std::vector<sim_ds::pattern_matching::SetBom::Match> answer;
+    for (size_t id = 0; id < keys.size(); id++) {
+        for (auto pos : sim_ds::pattern_matching::PatternMatchSimple(text, keys[id]))
+            answer.push_back({pos, id});
+    }
+    std::sort(answer.begin(), answer.end(), [](auto& l, auto& r) {
+        return l.pos != r.pos ? l.pos < r.pos : l.key_id < r.key_id;
+    });
+    return answer;
+}
+
+template <class Matcher>
+std::vector<typename sim_ds::pattern_matching::StreamMatcher<Matcher>::match_type>
+stream_in_chunks(Matcher matcher, std::string_view text, size_t max_chunk = 12) {
+    sim_ds::pattern_matching::StreamMatcher<Matcher> stream(std::move(matcher));
+    std::vector<typename sim_ds::pattern_matching::StreamMatcher<Matcher>::match_type> matchies;
+    size_t pos = 0;
+    while (pos < text.size()) {
+        auto chunk = text.substr(pos, rand() % max_chunk);
+        for (auto m : stream.feed(chunk))
+            matchies.push_back(m);
+        pos += chunk.size();
+    }
+    EXPECT_EQ(stream.consumed(), text.size());
+    return matchies;
+}
+
+}
+
+TEST(PatternMatching, SetBom_sample) {
+    EXPECT_EQ(sim_ds::pattern_matching::PatternMatchSetBOM(sample_text, sample_keys), set_answer(sample_text, sample_keys));
+}
+
+TEST(PatternMatching, SetBom_large) {
+    EXPECT_EQ(sim_ds::pattern_matching::PatternMatchSetBOM(sample_text_large, sample_keys), set_answer(sample_text_large, sample_keys));
+}
+
+TEST(PatternMatching, SetBom_all_bytes) {
+    // Prefixes of keys cover every byte but '\0', so no byte is left to join them.
+    std::vector<std::string> key_strings;
+    for (int c = 1; c < 0x100; c++)
+        key_strings.push_back({char(c), char(c * 7 % 0xFF + 1), char(c * 13 % 0xFF + 1)});
+    std::vector<std::string_view> keys(key_strings.begin(), key_strings.end());
+    std::string text;
+    for (int i = 0; i < (1<<16); i++)
+        text.push_back(rand() % 4 == 0 ? key_strings[rand() % key_strings.size()][i % 3] : char(rand() % 0x100));
+    for (int i = 0; i < 0x100; i++)
+        text += key_strings[rand() % key_strings.size()];
+    EXPECT_EQ(sim_ds::pattern_matching::PatternMatchSetBOM(text, keys), set_answer(text, keys));
+}
+
+TEST(PatternMatching, SetBom_null_in_key) {
+    std::vector<std::string_view> keys{"abc", std::string_view("a\0c", 3)};
+    EXPECT_THROW(sim_ds::pattern_matching::SetBom{keys}, std::invalid_argument);
+}
+
+TEST(PatternMatching, StreamBom_large) {
+    auto matchies = stream_in_chunks(sim_ds::pattern_matching::Bom(sample_key), sample_text_large);
+    EXPECT_EQ(matchies, sample_answer_large);
+}
+
+// Chunks shorter than the key are only scanned across their boundaries.
+const std::string sample_long_key = "abcababxabcab";
+const std::string_view sample_text_medium = std::string_view(sample_text_large).substr(0, 1<<16);
+
+TEST(PatternMatching, StreamSundayQS_short_chunks) {
+    auto answer = sim_ds::pattern_matching::PatternMatchSimple(sample_text_medium, sample_long_key);
+    ASSERT_FALSE(answer.empty());
+    auto matchies = stream_in_chunks(sim_ds::pattern_matching::SundayQS(sample_long_key), sample_text_medium, 4);
+    EXPECT_EQ(matchies, answer);
+}
+
+TEST(PatternMatching, StreamSundayMS_short_chunks) {
+    auto answer = sim_ds::pattern_matching::PatternMatchSimple(sample_text_medium, sample_long_key);
+    auto matchies = stream_in_chunks(sim_ds::pattern_matching::SundayMS(sample_long_key), sample_text_medium, 4);
+    EXPECT_EQ(matchies, answer);
+}
+
+TEST(PatternMatching, StreamAuto_short_chunks) {
+    auto answer = sim_ds::pattern_matching::PatternMatchSimple(sample_text_medium, sample_long_key);
+    auto matchies = stream_in_chunks(sim_ds::pattern_matching::Auto(sample_long_key), sample_text_medium, 4);
+    EXPECT_EQ(matchies, answer);
+}
+
+TEST(PatternMatching, StreamSetBom_large) {
+    auto matchies = stream_in_chunks(sim_ds::pattern_matching::SetBom(sample_keys), sample_text_large);
+    // Matches are fed in order of their ends.
+    std::sort(matchies.begin(), matchies.end(), [](auto& l, auto& r) {
+        return l.pos != r.pos ? l.pos < r.pos : l.key_id < r.key_id;
+    });
+    EXPECT_EQ(matchies, set_answer(sample_text_large, sample_keys));
+}
+
+TEST(PatternMatching, Simd_sample) {
+    EXPECT_EQ(sim_ds::pattern_matching::PatternMatchSIMD(sample_text, sample_key), sample_answer);
+}
+
+TEST(PatternMatching, Simd_large) {
+    EXPECT_EQ(sim_ds::pattern_matching::PatternMatchSIMD(sample_text_large, sample_key), sample_answer_large);
+}
+
+TEST(PatternMatching, Auto_keys) {
+    // Keys of each length and alphabet size, including bytes over 0x7F.
+    std::string text;
+    for (size_t i = 0; i < 0x10000; i++)
+        text.push_back(i % 3 ? 'a' + rand() % 4 : 0x80 + rand() % 64);
+    std::string_view text_view(text);
+    for (size_t size : {1, 2, 3, 5, 31, 32, 33, 64, 200}) {
+        auto key = text_view.substr(rand() % (text.size() - size), size);
+        sim_ds::pattern_matching::Auto matcher(key);
+        EXPECT_EQ(matcher.find_all(text), sim_ds::pattern_matching::PatternMatchSimple(text, key)) << matcher.algorithm();
+        EXPECT_EQ(sim_ds::pattern_matching::PatternMatchSIMD(text, key), sim_ds::pattern_matching::PatternMatchSimple(text, key));
+    }
+}
+
+namespace {
+
+template <class Matcher>
+void test_callbacks(std::string_view text, std::string_view key) {
+    Matcher matcher(key);
+    auto answer = sim_ds::pattern_matching::PatternMatchSimple(text, key);
+    size_t cnt = 0;
+    matcher.for_each_match(text, [&](size_t pos) {
+        EXPECT_LT(cnt, answer.size());
+        EXPECT_EQ(pos, answer[cnt]);
+        cnt++;
+    });
+    EXPECT_EQ(cnt, answer.size());
+    EXPECT_EQ(matcher.count(text), answer.size());
+    auto first = matcher.find_first(text);
+    EXPECT_EQ(first.has_value(), not answer.empty());
+    if (first) {
+        EXPECT_EQ(*first, answer.front());
+    }
+    std::vector<size_t> copied(answer.size());
+    EXPECT_EQ(matcher.find_all(text, copied.begin()), copied.end());
+    EXPECT_EQ(copied, answer);
+}
+
+}
+
+TEST(PatternMatching, callbacks) {
+    using namespace sim_ds::pattern_matching;
+    for (auto key : {std::string_view(sample_key), std::string_view("xyz")}) {
+        test_callbacks<Simple>(sample_text_large, key);
+        test_callbacks<Kmp>(sample_text_large, key);
+        test_callbacks<Bm>(sample_text_large, key);
+        test_callbacks<Bom>(sample_text_large, key);
+        test_callbacks<TurboBom>(sample_text_large, key);
+        test_callbacks<SundayQS>(sample_text_large, key);
+        test_callbacks<SundayMS>(sample_text_large, key);
+        test_callbacks<Simd>(sample_text_large, key);
+        test_callbacks<Auto>(sample_text_large, key);
+    }
+    
+    SetBom set_bom(sample_keys);
+    EXPECT_EQ(set_bom.count(sample_text_large), set_answer(sample_text_large, sample_keys).size());
+    EXPECT_EQ(*set_bom.find_first(sample_text_large), set_answer(sample_text_large, sample_keys).front());
+}
+
+namespace {
+
+template <class Matcher>
+void test_parallel(std::string_view text, std::string_view key) {
+    auto answer = sim_ds::pattern_matching::PatternMatchSimple(text, key);
+    for (unsigned num_threads : {1, 3, 8}) {
+        sim_ds::pattern_matching::ParallelMatcher<Matcher> matcher(Matcher(key), num_threads);
+        EXPECT_EQ(matcher.find_all(text), answer) << num_threads;
+        EXPECT_EQ(matcher.count(text), answer.size()) << num_threads;
+    }
+}
+
+}
+
+TEST(PatternMatching, parallel) {
+    using namespace sim_ds::pattern_matching;
+    ASSERT_GT(sample_text_large.size(), ParallelMatcher<Bom>::kMinChunkSize * 8);
+    test_parallel<Kmp>(sample_text_large, sample_key);
+    test_parallel<Bom>(sample_text_large, sample_key);
+    test_parallel<SundayMS>(sample_text_large, sample_key);
+    test_parallel<Simd>(sample_text_large, sample_key);
+    test_parallel<Auto>(sample_text_large, sample_key);
+    
+    // Matches across boundaries of chunks, in text of a repeated byte
+    std::string text(ParallelMatcher<Bom>::kMinChunkSize * 5 + 7, 'a');
+    test_parallel<Simd>(text, "aaaa");
+    
+    ParallelMatcher<SetBom> set_matcher(SetBom(sample_keys), 4);
+    EXPECT_EQ(set_matcher.find_all(sample_text_large), set_answer(sample_text_large, sample_keys));
+    size_t cnt = 0;
+    set_matcher.for_each_match(sample_text_large, [&](auto&) {return ++cnt < 10;});
+    EXPECT_EQ(cnt, 10);
+}
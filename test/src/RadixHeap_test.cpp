@@ -0,0 +1,93 @@
+#include "gtest/gtest.h"
+#include "sim_ds/RadixHeap.hpp"
+#include "sim_ds/Heap.hpp"
+
+#include <random>
+
+namespace {
+
+// Pop keys in monotone order while pushing keys not less than the last popped one.
+template <class Queue>
+std::vector<uint64_t> MonotoneSequence(uint64_t max_step) {
+    std::mt19937_64 rnd(0);
+    Queue queue;
+    std::vector<uint64_t> popped;
+    for (int i = 0; i < 1024; i++)
+        queue.push(rnd() % max_step);
+    uint64_t last = 0;
+    for (int t = 0; t < (1<<16); t++) {
+        auto k = rnd() % 3;
+        for (int i = 0; i < k; i++)
+            queue.push(last + rnd() % max_step);
+        if (queue.empty())
+            continue;
+        last = queue.top();
+        popped.push_back(last);
+        queue.pop();
+    }
+    while (!queue.empty()) {
+        popped.push_back(queue.top());
+        queue.pop();
+    }
+    return popped;
+}
+
+}
+
+TEST(RadixHeapTest, Monotone) {
+    for (uint64_t step : {1ull, 100ull, 1ull<<20, 1ull<<40}) {
+        auto expected = MonotoneSequence<sim_ds::DaryHeap<uint64_t>>(step);
+        EXPECT_TRUE(std::is_sorted(expected.begin(), expected.end()));
+        EXPECT_EQ(MonotoneSequence<sim_ds::RadixHeap<uint64_t>>(step), expected);
+    }
+}
+
+TEST(BucketQueueTest, Monotone) {
+    for (uint64_t step : {1ull, 10ull, 1000ull}) {
+        auto expected = MonotoneSequence<sim_ds::DaryHeap<uint64_t>>(step);
+        EXPECT_EQ(MonotoneSequence<sim_ds::BucketQueue<uint64_t>>(step), expected);
+    }
+}
+
+TEST(RadixHeapTest, Pair) {
+    std::vector<std::pair<uint64_t, int>> src;
+    for (int i = 0; i < 256; i++)
+        src.emplace_back((i * 37) % 101, i);
+    sim_ds::RadixHeap<std::pair<uint64_t, int>> radix(src.begin(), src.end());
+    sim_ds::BucketQueue<std::pair<uint64_t, int>> bucket(src.begin(), src.end());
+    std::sort(src.begin(), src.end());
+    for (size_t i = 0; i < src.size(); i++) {
+        EXPECT_EQ(radix.top().first, src[i].first);
+        EXPECT_EQ(bucket.top().first, src[i].first);
+        radix.pop();
+        bucket.pop();
+    }
+    EXPECT_TRUE(radix.empty());
+    EXPECT_TRUE(bucket.empty());
+}
+
+TEST(RadixHeapTest, PushAfterTop) {
+    sim_ds::RadixHeap<uint64_t> radix;
+    sim_ds::BucketQueue<uint64_t> bucket;
+    radix.push(10);
+    bucket.push(10);
+    EXPECT_EQ(radix.top(), 10);
+    EXPECT_EQ(bucket.top(), 10);
+    // Keys between the last popped key and the minimum are still allowed after peeking.
+    radix.push(7);
+    bucket.push(7);
+    EXPECT_EQ(radix.top(), 7);
+    EXPECT_EQ(bucket.top(), 7);
+    radix.pop();
+    bucket.pop();
+    EXPECT_EQ(radix.top(), 10);
+    EXPECT_EQ(bucket.top(), 10);
+    radix.push(8);
+    bucket.push(8);
+    EXPECT_EQ(radix.top(), 8);
+    EXPECT_EQ(bucket.top(), 8);
+    radix.pop();
+    bucket.pop();
+    EXPECT_EQ(radix.top(), 10);
+    EXPECT_EQ(bucket.top(), 10);
+}
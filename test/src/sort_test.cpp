@@ -8,6 +8,8 @@
 #include "gtest/gtest.h"
 #include "sim_ds/sort.hpp"
 
+#include <random>
+
 TEST(SortTest, heap) {
     size_t size = 0x10000;
     std::vector<size_t> vec(size);
@@ -24,3 +26,50 @@ TEST(SortTest, heap) {
         EXPECT_EQ(vec[i], heap_vec[i]);
     }
 }
+
+TEST(SortTest, radix) {
+    std::mt19937_64 rnd(0);
+    for (size_t size : {10, 1000, 0x10000}) {
+        std::vector<uint64_t> vec(size);
+        for (auto& v : vec)
+            v = rnd() >> (rnd() % 64);
+        auto lsd_vec = vec, msd_vec = vec;
+        std::sort(vec.begin(), vec.end());
+        sim_ds::RadixSort(lsd_vec.begin(), lsd_vec.end());
+        sim_ds::MsdRadixSort(msd_vec.begin(), msd_vec.end());
+        EXPECT_EQ(lsd_vec, vec);
+        EXPECT_EQ(msd_vec, vec);
+    }
+    std::vector<int> ivec(0x1000);
+    for (auto& v : ivec)
+        v = int(rnd() % 2001) - 1000;
+    auto lsd_ivec = ivec, msd_ivec = ivec;
+    std::sort(ivec.begin(), ivec.end());
+    sim_ds::RadixSort(lsd_ivec.begin(), lsd_ivec.end());
+    sim_ds::MsdRadixSort(msd_ivec.begin(), msd_ivec.end());
+    EXPECT_EQ(lsd_ivec, ivec);
+    EXPECT_EQ(msd_ivec, ivec);
+}
+
+TEST(SortTest, radix_stable) {
+    std::mt19937 rnd(0);
+    std::vector<std::pair<uint16_t, size_t>> vec(0x10000);
+    for (size_t i = 0; i < vec.size(); i++)
+        vec[i] = {rnd() % 100, i};
+    auto radix_vec = vec;
+    std::stable_sort(vec.begin(), vec.end(), [](auto& l, auto& r) {return l.first < r.first;});
+    sim_ds::RadixSort(radix_vec.begin(), radix_vec.end(), [](auto& p) {return p.first;});
+    EXPECT_EQ(radix_vec, vec);
+}
+
+TEST(SortTest, sample) {
+    std::mt19937_64 rnd(0);
+    std::vector<std::string> vec(1u<<17);
+    for (auto& v : vec)
+        v = std::to_string(rnd() % 100000);
+    auto sample_vec = vec;
+    auto greater = [](auto& l, auto& r) {return l > r;};
+    std::sort(vec.begin(), vec.end(), greater);
+    sim_ds::SampleSort(sample_vec.begin(), sample_vec.end(), greater, 4);
+    EXPECT_EQ(sample_vec, vec);
+}